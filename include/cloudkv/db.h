@@ -8,6 +8,7 @@
 #include <boost/noncopyable.hpp>
 #include "cloudkv/options.h"
 #include "cloudkv/iter.h"
+#include "cloudkv/pinnable_value.h"
 #include "cloudkv/write_batch.h"
 
 namespace cloudkv {
@@ -17,7 +18,28 @@ class kv_store : private boost::noncopyable {
 public:
     virtual ~kv_store() = default;
 
-    virtual std::optional<std::string> query(std::string_view key) = 0;
+    std::optional<std::string> query(std::string_view key)
+    {
+        return query(read_options{}, key);
+    }
+
+    virtual std::optional<std::string> query(const read_options& opts, std::string_view key) = 0;
+
+    // false if not found, the value points into cached blocks or rows if possible instead of a copy
+    bool query(std::string_view key, pinnable_value* value)
+    {
+        return query(read_options{}, key, value);
+    }
+
+    virtual bool query(const read_options& opts, std::string_view key, pinnable_value* value) = 0;
+
+    // values in the order of keys, looked up against the same snapshot
+    std::vector<std::optional<std::string>> multi_query(const std::vector<std::string_view>& keys)
+    {
+        return multi_query(read_options{}, keys);
+    }
+
+    virtual std::vector<std::optional<std::string>> multi_query(const read_options& opts, const std::vector<std::string_view>& keys) = 0;
 
     virtual void batch_add(const write_batch& batch) = 0;
 
@@ -25,7 +47,20 @@ public:
 
     virtual void remove(std::string_view key) = 0;
 
-    virtual iter_ptr iter() = 0;
+    // numeric properties, nullopt if unknown
+    //  cloudkv.pinned-bytes       index and filter blocks pinned, see options::pin_index_and_filter
+    //  cloudkv.block-cache-bytes  data blocks cached
+    //  cloudkv.row-cache-hits     queries served by the row cache, see options::row_cache_size
+    //  cloudkv.row-cache-misses
+    //  cloudkv.row-cache-bytes
+    virtual std::optional<std::uint64_t> property(std::string_view name) = 0;
+
+    iter_ptr iter()
+    {
+        return iter(read_options{});
+    }
+
+    virtual iter_ptr iter(const read_options& opts) = 0;
 };
 
 using kv_ptr = std::unique_ptr<kv_store>;
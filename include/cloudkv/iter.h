@@ -14,8 +14,14 @@ public:
     virtual void seek_first() = 0;
     virtual void seek(std::string_view key) = 0;
 
+    virtual void seek_last() = 0;
+    // the last key not greater than key
+    virtual void seek_for_prev(std::string_view key) = 0;
+
     virtual bool is_eof() = 0;
     virtual void next() = 0;
+    // eof after the first key
+    virtual void prev() = 0;
 
     // keep valid until any mutation is performed
     struct key_value_pair {
@@ -1,15 +1,57 @@
 #pragma once
 
 #include <cstdint>
+#include <string>
 
 namespace cloudkv {
 
+// values are kept in sstable block trailers
+enum class compression_type : std::uint8_t {
+    none = 0,
+    lz4 = 1,
+    zstd = 2,
+};
+
 struct options {
     bool open_only = false;
     std::uint64_t write_buffer_size = 4 * 1024 * 1024;
     std::uint64_t sstable_size = 16 * 1024 * 1024;
     std::uint64_t compaction_water_mark = 8;
     std::uint32_t block_size = 32 * 1024;
+    std::uint32_t block_restart_interval = 16;  // keys between restart points of prefix compressed blocks
+    bool block_key_heads = true;  // 8 more bytes per restart point, seeks binary search them without decoding keys
+    bool data_block_hash_index = true;  // point lookups jump to the restart point by key hash, ~1.3 bytes per key
+    bool index_model = false;  // learn positions of keys in unpartitioned data indexes, lookups search a window of them
+    std::uint32_t index_partition_size = 0;  // split data indexes into partitions of this size loaded on demand, 0 to disable
+    std::uint64_t max_open_sstables = 1024;
+    std::uint64_t block_cache_size = 64 * 1024 * 1024;
+    std::uint64_t row_cache_size = 0;  // bytes of keys and values found in sstables cached for queries, 0 to disable
+    bool pin_index_and_filter = false;  // keep live sstables opened with their index and filter, so lookups only read data blocks
+    std::uint64_t pinned_memory_budget = 256 * 1024 * 1024;  // bytes of pinned indexes and filters, the rest are cached as usual
+    std::uint32_t bloom_bits_per_key = 10;  // 0 to disable filters
+    std::uint32_t io_queue_depth = 32;  // block reads in flight for lookups probing several sstables, 0 to read one by one
+    bool use_io_uring = true;  // or a pool of threads doing pread, also used if the kernel refuses io_uring
+    bool use_mmap_reads = false;  // serve uncompressed sstable blocks from mapped files without caching
+    bool use_direct_io = false;  // sstable reads and writes bypass page cache, leaving caching to the block cache, takes precedence over mmap
+    compression_type compression = compression_type::lz4;  // for data blocks of memtable checkpoints
+    compression_type bottommost_compression = compression_type::zstd;  // for compaction outputs, which hold the oldest data
+    double min_compression_ratio = 1.125;  // blocks which shrink less are stored uncompressed
+    std::uint64_t compaction_readahead_size = 2 * 1024 * 1024;  // read ahead of compaction inputs at most, 0 to disable
+    std::uint64_t min_blob_size = 0;  // values of at least this size are checkpointed to blob files, sstables keep references to them, 0 to disable
+    double blob_gc_ratio = 0.5;  // compactions rewrite live values of blob files with at least this fraction of bytes discardable
+};
+
+struct read_options {
+    // check crc of sstable blocks read from files, cached blocks were checked when loaded
+    bool verify_checksums = true;
+
+    // iterators read ahead at most so many bytes once their block reads turn sequential, 0 to disable
+    std::uint64_t readahead_size = 0;
+
+    // iterators only see user keys in [lower_bound, upper_bound), empty means unbounded
+    // sstables out of the range are skipped, and no blocks are read past it
+    std::string lower_bound;
+    std::string upper_bound;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <boost/noncopyable.hpp>
+
+namespace cloudkv {
+
+/**
+ * @brief value filled by kv_store::query without copying if possible
+ *
+ * it points into memory of the db, eg. a cached block or a cached row, which is kept alive
+ * until the value is reset or destroyed, or into a buffer of its own otherwise
+ */
+class pinnable_value : private boost::noncopyable {
+public:
+    pinnable_value() = default;
+
+    pinnable_value(pinnable_value&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    pinnable_value& operator=(pinnable_value&& other) noexcept
+    {
+        if (this == &other) {
+            return *this;
+        }
+
+        pin_ = std::move(other.pin_);
+        buf_ = std::move(other.buf_);
+        value_ = pin_? other.value_: std::string_view(buf_);
+        other.reset();
+
+        return *this;
+    }
+
+    std::string_view value() const
+    {
+        return value_;
+    }
+
+    std::size_t size() const
+    {
+        return value_.size();
+    }
+
+    // whether memory of the db is held
+    bool is_pinned() const
+    {
+        return pin_ != nullptr;
+    }
+
+    // v keeps valid as long as owner lives
+    void pin(std::string_view v, std::shared_ptr<const void> owner)
+    {
+        pin_ = std::move(owner);
+        buf_.clear();
+        value_ = v;
+    }
+
+    void assign(std::string_view v)
+    {
+        pin_.reset();
+        buf_.assign(v.data(), v.size());
+        value_ = buf_;
+    }
+
+    void assign(std::string&& v)
+    {
+        pin_.reset();
+        buf_ = std::move(v);
+        value_ = buf_;
+    }
+
+    void reset()
+    {
+        pin_.reset();
+        buf_.clear();
+        value_ = {};
+    }
+
+private:
+    std::shared_ptr<const void> pin_;
+    std::string buf_;
+    std::string_view value_;
+};
+
+}
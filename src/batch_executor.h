@@ -47,9 +47,11 @@ private:
     std::condition_variable work_doable_;
     std::vector<task_ptr> task_queue_;
     std::vector<task_ptr> working_set_;
-    std::thread executor_;
 
     std::atomic_bool stopped_ { false };
+
+    // last, the thread reads all above once started
+    std::thread executor_;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include <limits>
+#include <stdexcept>
+#include <fmt/core.h>
+#include "blob/blob_file.h"
+#include "cloudkv/exception.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
+#include "util/direct_filebuf.h"
+#include "util/exception_util.h"
+#include "util/fmt_std.h"
+
+using namespace cloudkv;
+
+void blob_ref::encode_to(std::string* buf) const
+{
+    PutFixed64(buf, file_id);
+    PutFixed64(buf, offset);
+    PutFixed32(buf, size);
+}
+
+blob_ref blob_ref::decode(std::string_view buf)
+{
+    if (buf.size() != encoded_size) {
+        throw data_corrupted{ fmt::format("invalid blob ref of size {}", buf.size()) };
+    }
+
+    return { DecodeFixed64(buf.data()), DecodeFixed64(buf.data() + 8), DecodeFixed32(buf.data() + 16) };
+}
+
+blob_file_builder::blob_file_builder(const options& opts, const path_t& p, std::uint64_t file_id)
+    : path_(p),
+      file_id_(file_id),
+      filebuf_(open_output_file(p, opts.use_direct_io)),
+      out_(filebuf_.get())
+{
+    out_.exceptions(std::ios::failbit | std::ios::badbit);
+}
+
+blob_ref blob_file_builder::add(std::string_view value)
+{
+    if (value.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::invalid_argument{ fmt::format("value of {} bytes is too large for blob {}", value.size(), path_) };
+    }
+
+    std::string header;
+    header.reserve(blob_record_header_size);
+    PutFixed32(&header, crc32c::mask(crc32c::value(value)));
+    PutFixed32(&header, value.size());
+
+    out_.write(header.data(), header.size());
+    out_.write(value.data(), value.size());
+
+    const blob_ref ref{ file_id_, offset_, static_cast<std::uint32_t>(value.size()) };
+    offset_ += header.size() + value.size();
+    total_bytes_ += value.size();
+
+    return ref;
+}
+
+void blob_file_builder::done()
+{
+    // commit
+    out_.flush();
+}
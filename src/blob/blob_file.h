@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "core.h"
+#include "cloudkv/options.h"
+
+namespace cloudkv {
+
+// where a separated value lives, kept as the value of blob_index entries in sstables
+struct blob_ref {
+    enum { encoded_size = 2 * sizeof(std::uint64_t) + sizeof(std::uint32_t) };
+
+    std::uint64_t file_id = 0;
+    std::uint64_t offset = 0;  // of the record
+    std::uint32_t size = 0;    // of the value
+
+    void encode_to(std::string* buf) const;
+
+    // throw data_corrupted if invalid
+    static blob_ref decode(std::string_view buf);
+};
+
+// kept in meta, bytes of values no sstable refers to any more are discardable
+struct blob_file_meta {
+    std::uint64_t file_id = 0;
+    std::uint64_t total_bytes = 0;
+    std::uint64_t discardable_bytes = 0;
+};
+
+inline constexpr std::size_t blob_record_header_size = 2 * sizeof(std::uint32_t);
+
+/**
+ * @brief append-only file of values
+ *
+ * [record1]
+ *      [masked crc32c of value]  uint32_t
+ *      [value size]  uint32_t
+ *      [value]
+ * [record2]
+ * ...
+ *
+ * basic guarantee
+ */
+class blob_file_builder {
+public:
+    // written by O_DIRECT if opts.use_direct_io
+    blob_file_builder(const options& opts, const path_t& p, std::uint64_t file_id);
+
+    blob_ref add(std::string_view value);
+
+    void done();
+
+    // total_bytes counts values only
+    blob_file_meta meta() const
+    {
+        return { file_id_, total_bytes_, 0 };
+    }
+
+    const path_t& target() const
+    {
+        return path_;
+    }
+
+private:
+    const path_t path_;
+    const std::uint64_t file_id_;
+    std::unique_ptr<std::streambuf> filebuf_;
+    std::ostream out_;
+
+    std::uint64_t offset_ = 0;
+    std::uint64_t total_bytes_ = 0;
+};
+
+}
@@ -0,0 +1,42 @@
+#include <fmt/core.h>
+#include "blob/blob_store.h"
+#include "cloudkv/exception.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
+#include "util/fmt_std.h"
+
+using namespace cloudkv;
+
+blob_store::blob_store(const path_conf& db_path, std::uint64_t max_open_files, bool use_direct_io)
+    : db_path_(db_path),
+      use_direct_io_(use_direct_io),
+      files_(max_open_files)
+{
+}
+
+std::string_view blob_store::get(const blob_ref& ref, bool verify_checksums, std::string* scratch)
+{
+    auto file = files_.find(ref.file_id);
+    if (!file) {
+        // opening races are harmless, the later one wins
+        file = std::make_shared<random_access_file>(db_path_.blob_path(ref.file_id), false, access_hint::random, use_direct_io_);
+        files_.insert(ref.file_id, file, 1);
+    }
+
+    const auto record = file->read(ref.offset, blob_record_header_size + ref.size, scratch);
+    if (DecodeFixed32(record.data() + sizeof(std::uint32_t)) != ref.size) {
+        throw data_corrupted{ fmt::format("blob record at {} of {} mismatches its ref", ref.offset, file->path()) };
+    }
+
+    const auto value = record.substr(blob_record_header_size);
+    if (verify_checksums && crc32c::unmask(DecodeFixed32(record.data())) != crc32c::value(value)) {
+        throw data_corrupted{ fmt::format("blob record at {} of {} corrupted", ref.offset, file->path()) };
+    }
+
+    return value;
+}
+
+void blob_store::evict(std::uint64_t file_id)
+{
+    files_.erase(file_id);
+}
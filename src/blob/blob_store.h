@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "core.h"
+#include "path_conf.h"
+#include "blob/blob_file.h"
+#include "util/lru_cache.h"
+#include "util/random_access_file.h"
+
+namespace cloudkv {
+
+/**
+ * @brief keep blob files opened for reads of separated values
+ *
+ * thread safe
+ */
+class blob_store : private noncopyable {
+public:
+    blob_store(const path_conf& db_path, std::uint64_t max_open_files, bool use_direct_io = false);
+
+    // the result points to scratch, throw data_corrupted if the record mismatches ref
+    std::string_view get(const blob_ref& ref, bool verify_checksums, std::string* scratch);
+
+    // readers in use keep valid
+    void evict(std::uint64_t file_id);
+
+private:
+    const path_conf& db_path_;
+    const bool use_direct_io_;
+    lru_cache<std::uint64_t, random_access_file> files_;
+};
+
+}
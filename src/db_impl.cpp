@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <chrono>
+#include <numeric>
 #include <thread>
 #include <filesystem>
 #include <vector>
@@ -11,7 +13,6 @@
 #include "util/fmt_std.h"
 #include "util/strict_lock_guard.h"
 #include "util/exception_util.h"
-#include "util/iter_util.h"
 #include "task/gc_task.h"
 #include "task/checkpoint_task.h"
 #include "task/compaction_task.h"
@@ -32,6 +33,12 @@ using std::nullopt;
 db_impl::db_impl(std::string_view name, const options& opts)
     : options_(opts),
       db_path_(name),
+      io_(opts.io_queue_depth > 0? make_async_io(opts.io_queue_depth, opts.use_io_uring): nullptr),
+      block_cache_(opts.block_cache_size),
+      table_cache_(opts.max_open_sstables, { &block_cache_, opts.use_mmap_reads, access_hint::random, io_.get(), opts.use_direct_io },
+                   opts.pin_index_and_filter? opts.pinned_memory_budget: 0),
+      blob_store_(db_path_, opts.max_open_sstables, opts.use_direct_io),
+      row_cache_(opts.row_cache_size > 0? std::make_unique<row_cache>(opts.row_cache_size): nullptr),
       active_memtable_(std::make_shared<memtable>()),
       write_executor_([this](const write_batch& batch){ commit_(batch); })
 {
@@ -47,6 +54,7 @@ db_impl::db_impl(std::string_view name, const options& opts)
         fs::create_directory(db_path_.root());
         fs::create_directory(db_path_.redo_dir());
         fs::create_directory(db_path_.sst_dir());
+        fs::create_directory(db_path_.blob_dir());
 
         meta_.store(db_path_.meta_info());
     }
@@ -56,9 +64,12 @@ db_impl::db_impl(std::string_view name, const options& opts)
     }
 
     dblock_ = std::make_unique<file_lock>(db_path_.lock());
+    // missing in dbs created before blob files
+    fs::create_directories(db_path_.blob_dir());
     meta_ = metainfo::load(db_path_.meta_info());
     file_id_alloc_.reset(meta_.next_file_id);
     gc_root_.add(meta_.sstables);
+    sst_index_ = std::make_shared<sstable_index>(meta_.sstables);
 
     spdlog::info("[startup] load meta: root={} committed_file_id={}", db_path_.root(), meta_.committed_file_id);
 
@@ -68,46 +79,244 @@ db_impl::db_impl(std::string_view name, const options& opts)
 
     spdlog::info("[startup] replay");
     // redo log and sst can share file id, every usable sst's file_id must have been persisted
-    auto replay_res = replayer(db_path_, file_id_alloc_, meta_.committed_file_id).replay();
-    if (replay_res.replayed_file_id > meta_.committed_file_id) {
+    auto replay_res = replayer(db_path_, options_, file_id_alloc_, meta_.committed_file_id).replay();
+    const bool replayed = replay_res.replayed_file_id > meta_.committed_file_id;
+    if (replayed) {
         spdlog::info("[startup] replay done: file_id={}, sst={}",
             replay_res.replayed_file_id,
             replay_res.sstables.size());
 
         auto& sst = replay_res.sstables;
         meta_.committed_file_id = replay_res.replayed_file_id;
-        meta_.next_file_id = std::max(meta_.next_file_id, meta_.committed_file_id + 1);
+        // replayed sst and blob files took ids from the allocator, which must not be handed out again
+        meta_.next_file_id = std::max({meta_.next_file_id, meta_.committed_file_id + 1, file_id_alloc_.peek_next()});
         meta_.sstables.insert(meta_.sstables.end(), sst.begin(), sst.end());
+        meta_.blob_files.insert(meta_.blob_files.end(), replay_res.blob_files.begin(), replay_res.blob_files.end());
 
         meta_.store(db_path_.meta_info());
         file_id_alloc_.reset(meta_.next_file_id);
         gc_root_.add(replay_res.sstables);
+        sst_index_ = std::make_shared<sstable_index>(meta_.sstables);
+    }
 
+    // before compactions run, which may drop and evict any of them
+    pin_sstables_(meta_.sstables);
+    if (replayed) {
         try_compaction_();
     }
 
     redolog_ = std::make_shared<redolog>(db_path_.redo_path(file_id_alloc_.alloc()));
 }
 
-std::optional<std::string> db_impl::query(std::string_view key)
+std::optional<std::string> db_impl::query(const read_options& opts, std::string_view key)
 {
+    pinnable_value value;
+    if (!query(opts, key, &value)) {
+        return nullopt;
+    }
+
+    return std::string(value.value());
+}
+
+bool db_impl::query(const read_options& opts, std::string_view key, pinnable_value* value)
+{
+    value->reset();
+
+    std::uint64_t row_version = 0;
+    if (row_cache_) {
+        if (auto row = row_cache_->find(key)) {
+            if (row->deleted) {
+                return false;
+            }
+
+            const std::string_view v = row->value;
+            value->pin(v, std::move(row));
+            return true;
+        }
+        row_version = row_cache_->version(key);
+    }
+
     auto ctx = get_read_ctx_();
 
+    // values of memtables are updated in place, so they are copied
     for (const auto& memtable: ctx.memtables) {
         auto r = memtable->query(key);
         if (r) {
-            return r.value().key.is_deleted()? nullopt: std::optional(std::move(r.value().value));
+            if (r->key.is_deleted()) {
+                return false;
+            }
+
+            value->assign(std::move(r->value));
+            return true;
+        }
+    }
+
+    std::vector<sstable_get> lookups;
+    for (const auto& sst: ctx.sstables->covering(key)) {
+        if (sst->may_contain(key)) {
+            lookups.push_back({ sst.get(), key });
         }
     }
 
-    for (const auto& sst: ctx.sstables) {
-        auto p = query_key(sst->iter(), key);
+    // newer sstables come first, probe them one by one unless their reads can be in flight together
+    if (lookups.size() > 1 && table_cache_.io()) {
+        sstable::multi_get(table_cache_, lookups, opts);
+        for (const auto& lookup: lookups) {
+            if (lookup.result) {
+                const bool found = value_of_(*lookup.result, opts, value);
+                cache_row_(key, row_version, found? std::optional(value->value()): nullopt);
+                return found;
+            }
+        }
+
+        return false;
+    }
+
+    std::string scratch;
+    for (const auto& lookup: lookups) {
+        auto p = lookup.sst->get(table_cache_, key, opts, &scratch);
         if (p) {
-            return p->key.is_deleted()? std::nullopt: std::optional(p->value);
+            const bool found = value_of_(*p, opts, value);
+            cache_row_(key, row_version, found? std::optional(value->value()): nullopt);
+            return found;
         }
     }
 
-    return nullopt;
+    return false;
+}
+
+std::vector<std::optional<std::string>> db_impl::multi_query(const read_options& opts, const std::vector<std::string_view>& keys)
+{
+    std::vector<std::optional<std::string>> values(keys.size());
+
+    std::vector<std::size_t> pending;
+    pending.reserve(keys.size());
+    std::vector<std::uint64_t> row_versions(row_cache_? keys.size(): 0);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        if (!row_cache_) {
+            pending.push_back(i);
+        } else if (const auto row = row_cache_->find(keys[i])) {
+            if (!row->deleted) {
+                values[i] = row->value;
+            }
+        } else {
+            row_versions[i] = row_cache_->version(keys[i]);
+            pending.push_back(i);
+        }
+    }
+
+    auto ctx = get_read_ctx_();
+
+    // sorted, so that lookups of an sstable walk its data blocks in order
+    std::sort(pending.begin(), pending.end(), [&keys](std::size_t x, std::size_t y) {
+        return keys[x] < keys[y];
+    });
+
+    for (const auto& memtable: ctx.memtables) {
+        std::vector<user_key_ref> pending_keys;
+        pending_keys.reserve(pending.size());
+        for (const auto i: pending) {
+            pending_keys.push_back(keys[i]);
+        }
+
+        auto found = memtable->multi_query(pending_keys);
+        std::size_t remaining = 0;
+        for (std::size_t j = 0; j < pending.size(); ++j) {
+            auto& r = found[j];
+            if (!r) {
+                pending[remaining++] = pending[j];
+            } else if (!r->key.is_deleted()) {
+                values[pending[j]] = std::move(r->value);
+            }
+        }
+        pending.resize(remaining);
+    }
+
+    // candidates of each key, newest first
+    std::vector<std::vector<sstable*>> candidates(keys.size());
+    std::size_t rounds = 0;
+    for (const auto i: pending) {
+        for (const auto& sst: ctx.sstables->covering(keys[i])) {
+            if (sst->may_contain(keys[i])) {
+                candidates[i].push_back(sst.get());
+            }
+        }
+        rounds = std::max(rounds, candidates[i].size());
+    }
+
+    // the n-th candidates of all unresolved keys are looked up together, grouped by sstable
+    std::vector<sstable_get> lookups;
+    std::vector<std::size_t> owners;
+    for (std::size_t round = 0; round < rounds && !pending.empty(); ++round) {
+        std::vector<std::size_t> order;
+        for (const auto i: pending) {
+            if (round < candidates[i].size()) {
+                order.push_back(i);
+            }
+        }
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t x, std::size_t y) {
+            return candidates[x][round]->id() < candidates[y][round]->id();
+        });
+
+        lookups.clear();
+        owners.clear();
+        for (const auto i: order) {
+            lookups.push_back({ candidates[i][round], keys[i] });
+            owners.push_back(i);
+        }
+
+        sstable::multi_get(table_cache_, lookups, opts);
+
+        std::size_t remaining = 0;
+        for (std::size_t j = 0; j < lookups.size(); ++j) {
+            if (lookups[j].result) {
+                pinnable_value value;
+                if (value_of_(*lookups[j].result, opts, &value)) {
+                    values[owners[j]] = std::string(value.value());
+                }
+                if (row_cache_) {
+                    cache_row_(keys[owners[j]], row_versions[owners[j]], values[owners[j]]);
+                }
+                candidates[owners[j]].clear();
+            }
+        }
+        for (const auto i: pending) {
+            if (round + 1 < candidates[i].size()) {
+                pending[remaining++] = i;
+            }
+        }
+        pending.resize(remaining);
+    }
+
+    return values;
+}
+
+bool db_impl::value_of_(const lookup_result& r, const read_options& opts, pinnable_value* value)
+{
+    switch (extract_key_type(r.key)) {
+    case key_type::tombsome:
+        return false;
+
+    case key_type::blob_index: {
+        std::string scratch;
+        value->assign(blob_store_.get(blob_ref::decode(r.value), opts.verify_checksums, &scratch));
+        return true;
+    }
+
+    default:
+        // the block or the mapped file holding it
+        value->pin(r.value, r.pin);
+        return true;
+    }
+}
+
+void db_impl::cache_row_(user_key_ref key, std::uint64_t version, std::optional<std::string_view> value)
+{
+    if (!row_cache_) {
+        return;
+    }
+
+    row_cache_->insert(key, version, value);
 }
 
 void db_impl::batch_add(const write_batch& batch)
@@ -133,21 +342,55 @@ void db_impl::remove(std::string_view key)
     batch_add(batch);
 }
 
-iter_ptr db_impl::iter()
+iter_ptr db_impl::iter(const read_options& opts)
 {
     auto ctx = get_read_ctx_();
 
+    // sstables out of the bounds are never merged
+    const auto sstables = opts.lower_bound.empty() && opts.upper_bound.empty()?
+        ctx.sstables->all(): ctx.sstables->overlapping(opts.lower_bound, opts.upper_bound);
+
     std::vector<iter_ptr> iterators;
-    iterators.reserve(ctx.memtables.size() + ctx.sstables.size());
+    iterators.reserve(ctx.memtables.size() + sstables.size());
 
-    for (const auto& m: ctx.memtables) {
-        iterators.push_back(m->iter());
+    // from the oldest, later iterators win in merge
+    for (auto it = sstables.rbegin(); it != sstables.rend(); ++it) {
+        iterators.push_back((*it)->iter(table_cache_, opts));
+    }
+    for (auto it = ctx.memtables.rbegin(); it != ctx.memtables.rend(); ++it) {
+        iterators.push_back((*it)->iter());
+    }
+
+    return std::make_unique<db_iterator>(std::make_unique<merge_iterator>(std::move(iterators)), &blob_store_, opts);
+}
+
+std::optional<std::uint64_t> db_impl::property(std::string_view name)
+{
+    if (name == "cloudkv.pinned-bytes") {
+        return table_cache_.pinned_bytes();
     }
-    for (const auto& s: ctx.sstables) {
-        iterators.push_back(s->iter());
+    if (name == "cloudkv.block-cache-bytes") {
+        return block_cache_.bytes_used();
+    }
+    if (row_cache_ && name == "cloudkv.row-cache-hits") {
+        return row_cache_->hits();
+    }
+    if (row_cache_ && name == "cloudkv.row-cache-misses") {
+        return row_cache_->misses();
+    }
+    if (row_cache_ && name == "cloudkv.row-cache-bytes") {
+        return row_cache_->bytes_used();
+    }
+    if (name == "cloudkv.blob-bytes" || name == "cloudkv.blob-discardable-bytes") {
+        std::lock_guard _(mut_);
+        std::uint64_t bytes = 0;
+        for (const auto& b: meta_.blob_files) {
+            bytes += name == "cloudkv.blob-bytes"? b.total_bytes: b.discardable_bytes;
+        }
+        return bytes;
     }
 
-    return std::make_unique<db_iterator>(std::make_unique<merge_iterator>(std::move(iterators)));
+    return nullopt;
 }
 
 void db_impl::TEST_flush()
@@ -218,8 +461,11 @@ void db_impl::commit_(const write_batch& writes)
     // commit
     try {
         write_batch_accessor::iterate(writes,
-            [mt = active_memtable_.get()](const auto op, const auto key, const auto val){
+            [mt = active_memtable_.get(), rows = row_cache_.get()](const auto op, const auto key, const auto val){
                 mt->add(op, key, val);
+                if (rows) {
+                    rows->invalidate(key);
+                }
             });
     } catch (std::exception& e) {
         spdlog::critical("commit memtable failed after redo done: {}", e.what());
@@ -238,8 +484,7 @@ db_impl::read_ctx db_impl::get_read_ctx_()
         ctx.memtables.push_back(immutable_memtable_);
     }
 
-    using namespace ranges;
-    ctx.sstables = meta_.sstables | views::reverse | to<std::vector>();
+    ctx.sstables = sst_index_;
 
     return ctx;
 }
@@ -250,11 +495,12 @@ try {
         std::lock_guard _(mut_);
         return immutable_memtable_;
     }();
-    auto callback = [this](sstable_ptr sst){
-        on_checkpoint_done_(sst);
+    auto callback = [this](sstable_ptr sst, const std::vector<blob_file_meta>& blob_files){
+        on_checkpoint_done_(sst, blob_files);
     };
     auto task = std::make_unique<checkpoint_task>(checkpoint_task::checkpoint_ctx{
         db_path_,
+        options_,
         file_id_alloc_,
         gc_root_,
         std::move(memtable),
@@ -286,12 +532,13 @@ try {
         compaction_running_.clear();
     };
 
-    auto sstables = [this]{
+    auto [sstables, blob_files] = [this]{
         std::lock_guard _(mut_);
-        return meta_.sstables;
+        return std::make_pair(meta_.sstables, meta_.blob_files);
     }();
-    auto callback = [this](const std::vector<sstable_ptr>& added, const std::vector<sstable_ptr>& removed){
-        on_compaction_done_(added, removed);
+    auto callback = [this](const std::vector<sstable_ptr>& added, const std::vector<sstable_ptr>& removed,
+                           const std::vector<blob_file_meta>& blob_files){
+        on_compaction_done_(added, removed, blob_files);
         compaction_running_.clear();
     };
     auto task = std::make_unique<compaction_task>(compaction_task::compaction_ctx{
@@ -300,7 +547,9 @@ try {
         file_id_alloc_,
         gc_root_,
         std::move(sstables),
-        std::move(callback)
+        std::move(callback),
+        &blob_store_,
+        std::move(blob_files)
     });
 
     task_mgr_.submit(std::move(task), [this](const std::exception& e) noexcept {
@@ -311,7 +560,7 @@ try {
     spdlog::error("try compaction failed: {}, ignored", e.what());
 }
 
-void db_impl::on_checkpoint_done_(sstable_ptr sst)
+void db_impl::on_checkpoint_done_(sstable_ptr sst, const std::vector<blob_file_meta>& blob_files)
 {
     std::vector<sstable_ptr> added { sst };
     std::vector<sstable_ptr> removed;
@@ -323,7 +572,8 @@ void db_impl::on_checkpoint_done_(sstable_ptr sst)
     meta_update_args args {
         added,
         removed,
-        committed_file_id
+        committed_file_id,
+        blob_files
     };
     update_meta_(args);
 
@@ -333,7 +583,8 @@ void db_impl::on_checkpoint_done_(sstable_ptr sst)
     swap(immutable_memtable_, empty);
 }
 
-void db_impl::on_compaction_done_(const std::vector<sstable_ptr>& added, const std::vector<sstable_ptr>& removed)
+void db_impl::on_compaction_done_(const std::vector<sstable_ptr>& added, const std::vector<sstable_ptr>& removed,
+                                  const std::vector<blob_file_meta>& blob_files)
 {
     if (added.empty() && removed.empty()) {
         return;
@@ -342,13 +593,15 @@ void db_impl::on_compaction_done_(const std::vector<sstable_ptr>& added, const s
     meta_update_args args {
         added,
         removed,
-        0
+        0,
+        blob_files
     };
     update_meta_(args);
 }
 
 void db_impl::update_meta_(const meta_update_args& args)
 {
+    std::vector<std::uint64_t> dropped_blob_files;
     {
         std::lock_guard _(sys_mut_);
         auto meta = [this]{
@@ -380,6 +633,21 @@ void db_impl::update_meta_(const meta_update_args& args)
             sstables.swap(new_sstables);
         }
 
+        // recounted ones replace the old, and are dropped once no live value is left
+        for (const auto& b: args.blob_files) {
+            auto it = std::find_if(meta.blob_files.begin(), meta.blob_files.end(), [&b](const auto& x){ return x.file_id == b.file_id; });
+            if (b.discardable_bytes >= b.total_bytes) {
+                if (it != meta.blob_files.end()) {
+                    meta.blob_files.erase(it);
+                }
+                dropped_blob_files.push_back(b.file_id);
+            } else if (it != meta.blob_files.end()) {
+                *it = b;
+            } else {
+                meta.blob_files.push_back(b);
+            }
+        }
+
         meta.next_file_id = file_id_alloc_.peek_next();
         if (args.committed_file_id > meta.committed_file_id) {
             meta.committed_file_id = args.committed_file_id;
@@ -387,6 +655,8 @@ void db_impl::update_meta_(const meta_update_args& args)
 
         assert(meta.committed_file_id < meta.next_file_id);
 
+        sstable_index_ptr index = std::make_shared<sstable_index>(sstables);
+
         spdlog::info("[meta] store, committed_file_id={}, sst={} -> {}",
             meta.committed_file_id,
             old_sst_count,
@@ -402,17 +672,48 @@ void db_impl::update_meta_(const meta_update_args& args)
         gc_root_.add(added);
         meta.store(db_path_.meta_info());
 
+        // pinned before published, so the update removing them evicts after it
+        pin_sstables_(added);
+
         // post commit
         strict_lock_guard __(mut_);
         using namespace std;
         swap(meta_.committed_file_id, meta.committed_file_id);
         swap(meta_.sstables, meta.sstables);
+        swap(meta_.blob_files, meta.blob_files);
+        swap(sst_index_, index);
+    }
+
+    for (const auto& p: args.removed) {
+        table_cache_.evict(*p);
+    }
+    for (const auto id: dropped_blob_files) {
+        blob_store_.evict(id);
     }
 
     try_gc_();
     try_compaction_();
 }
 
+void db_impl::pin_sstables_(const std::vector<sstable_ptr>& sstables) noexcept
+{
+    if (!options_.pin_index_and_filter) {
+        return;
+    }
+
+    for (const auto& sst: sstables) {
+        try {
+            if (!table_cache_.pin(*sst)) {
+                spdlog::warn("[pin] budget {} exhausted, sst {} is cached as usual", options_.pinned_memory_budget, sst->path());
+                return;
+            }
+        } catch (std::exception& e) {
+            // lookups open it later and report errors
+            spdlog::warn("[pin] pin sst {} failed: {}", sst->path(), e.what());
+        }
+    }
+}
+
 void db_impl::try_gc_() noexcept
 try {
     const auto committed_file_id = [this]{
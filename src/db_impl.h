@@ -6,6 +6,10 @@
 #include "cloudkv/db.h"
 #include "memtable/memtable.h"
 #include "memtable/redolog.h"
+#include "sstable/block_cache.h"
+#include "sstable/table_cache.h"
+#include "sstable/sstable_index.h"
+#include "blob/blob_store.h"
 #include "task/task_manager.h"
 #include "util/file_lock.h"
 #include "meta.h"
@@ -13,6 +17,7 @@
 #include "gc_root.h"
 #include "path_conf.h"
 #include "batch_executor.h"
+#include "row_cache.h"
 
 namespace cloudkv {
 
@@ -20,14 +25,24 @@ class db_impl : public kv_store {
 public:
     db_impl(std::string_view name, const options& opts);
 
-    std::optional<std::string> query(std::string_view key) override;
+    using kv_store::query;
+    using kv_store::multi_query;
+    using kv_store::iter;
+
+    std::optional<std::string> query(const read_options& opts, std::string_view key) override;
+
+    bool query(const read_options& opts, std::string_view key, pinnable_value* value) override;
+
+    std::vector<std::optional<std::string>> multi_query(const read_options& opts, const std::vector<std::string_view>& keys) override;
 
     void batch_add(const write_batch& key_values) override;
 
     void add(std::string_view key, std::string_view value) override;
     void remove(std::string_view key) override;
 
-    iter_ptr iter() override;
+    iter_ptr iter(const read_options& opts) override;
+
+    std::optional<std::uint64_t> property(std::string_view name) override;
 
 public:
     // for tests
@@ -38,22 +53,33 @@ private:
     void commit_(const write_batch& batch);
 
     struct read_ctx {
-        std::vector<memtable_ptr> memtables;
-        std::vector<sstable_ptr> sstables;
+        std::vector<memtable_ptr> memtables;  // newest first
+        sstable_index_ptr sstables;
     };
     read_ctx get_read_ctx_();
 
+    // value of an sstable entry pinned, or read from blob files if separated, false if deleted
+    bool value_of_(const lookup_result& r, const read_options& opts, pinnable_value* value);
+
+    // versioned before the lookup found it, nullopt if deleted
+    void cache_row_(user_key_ref key, std::uint64_t version, std::optional<std::string_view> value);
+
+    // pin what fits in budget if enabled
+    void pin_sstables_(const std::vector<sstable_ptr>& sstables) noexcept;
+
     void try_checkpoint_() noexcept;
     void try_compaction_() noexcept;
     void try_gc_() noexcept;
 
-    void on_checkpoint_done_(sstable_ptr sst);
-    void on_compaction_done_(const std::vector<sstable_ptr>& added, const std::vector<sstable_ptr>& removed);
+    void on_checkpoint_done_(sstable_ptr sst, const std::vector<blob_file_meta>& blob_files);
+    void on_compaction_done_(const std::vector<sstable_ptr>& added, const std::vector<sstable_ptr>& removed,
+                             const std::vector<blob_file_meta>& blob_files);
 
     struct meta_update_args {
         const std::vector<sstable_ptr>& added;
         const std::vector<sstable_ptr>& removed;
         std::uint64_t committed_file_id;
+        const std::vector<blob_file_meta>& blob_files;  // new or recounted, dropped once all discardable
     };
     void update_meta_(const meta_update_args&);
 
@@ -68,8 +94,14 @@ private:
     std::mutex sys_mut_;  // for meta mutation
     std::mutex mut_;      // for db state
     metainfo meta_;
+    sstable_index_ptr sst_index_;  // rebuilt on every meta_.sstables change
     file_id_allocator file_id_alloc_;
     gc_root gc_root_;
+    std::unique_ptr<async_io> io_;
+    block_cache block_cache_;
+    table_cache table_cache_;
+    blob_store blob_store_;
+    std::unique_ptr<row_cache> row_cache_;  // null if disabled
 
     redolog_ptr redolog_;
     memtable_ptr active_memtable_;
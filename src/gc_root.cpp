@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "gc_root.h"
 
 using namespace cloudkv;
@@ -23,6 +24,20 @@ bool gc_root::is_reachable(const path_t& sst)
     return true;
 }
 
+bool gc_root::is_blob_reachable(std::uint64_t file_id)
+{
+    std::lock_guard _(mut_);
+
+    for (const auto& entry: reachable_) {
+        const auto sst = entry.second.lock();
+        if (sst && std::binary_search(sst->blob_files().begin(), sst->blob_files().end(), file_id)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void gc_root::add(sstable_ptr sst)
 {
     std::lock_guard _(mut_);
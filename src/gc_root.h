@@ -14,6 +14,9 @@ class gc_root : private boost::noncopyable {
 public:
     bool is_reachable(const path_t& sst);
 
+    // while any reachable sstable refers to it
+    bool is_blob_reachable(std::uint64_t file_id);
+
     // not atomic
     template <class Rng>
     void add(const Rng& rng)
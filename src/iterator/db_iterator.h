@@ -1,36 +1,70 @@
 #pragma once
 
+#include <string>
 #include "cloudkv/iter.h"
+#include "cloudkv/options.h"
+#include "blob/blob_store.h"
 #include "kv_format.h"
 
 /**
  * @brief iterator wrapper, convert internal key value to use key value
  *
+ * keys out of the bounds of read options are treated as eof
  */
 namespace cloudkv {
 
 class db_iterator : public kv_iter {
 public:
-    explicit db_iterator(iter_ptr iter)
-        : internal_iter_(std::move(iter))
+    // separated values are read from blobs, which must exist if there are any
+    explicit db_iterator(iter_ptr iter, blob_store* blobs = nullptr, const read_options& opts = {})
+        : internal_iter_(std::move(iter)),
+          blobs_(blobs),
+          verify_checksums_(opts.verify_checksums),
+          lower_(opts.lower_bound),
+          upper_(opts.upper_bound)
     {
     }
 
     void seek_first() override
     {
-        internal_iter_->seek_first();
+        if (lower_.empty()) {
+            internal_iter_->seek_first();
+        } else {
+            internal_iter_->seek(lower_);
+        }
         skip_deleted_();
     }
 
     void seek(std::string_view key) override
     {
-        internal_iter_->seek(key);
+        internal_iter_->seek(!lower_.empty() && key < lower_? lower_: key);
         skip_deleted_();
     }
 
+    void seek_last() override
+    {
+        if (upper_.empty()) {
+            internal_iter_->seek_last();
+        } else {
+            internal_iter_->seek_for_prev(upper_);
+        }
+        skip_deleted_backward_();
+    }
+
+    void seek_for_prev(std::string_view key) override
+    {
+        if (!upper_.empty() && key >= upper_) {
+            seek_last();
+            return;
+        }
+
+        internal_iter_->seek_for_prev(key);
+        skip_deleted_backward_();
+    }
+
     bool is_eof() override
     {
-        return internal_iter_->is_eof();
+        return out_of_bounds_ || internal_iter_->is_eof();
     }
 
     void next() override
@@ -39,13 +73,21 @@ public:
         skip_deleted_();
     }
 
+    void prev() override
+    {
+        internal_iter_->prev();
+        skip_deleted_backward_();
+    }
+
     key_value_pair current() override
     {
         auto kv = internal_iter_->current();
+        const auto ikey = internal_key_ref::parse(kv.key);
 
-        // fixme: so ugly
-        // remove tag
-        kv.key.remove_suffix(1);
+        if (ikey.is_blob_index()) {
+            kv.value = blobs_->get(blob_ref::decode(kv.value), verify_checksums_, &value_buf_);
+        }
+        kv.key = ikey.user_key();
 
         return kv;
     }
@@ -53,8 +95,13 @@ public:
 private:
     void skip_deleted_()
     {
+        out_of_bounds_ = false;
         while (!internal_iter_->is_eof()) {
-            const auto ikey = internal_key::parse(internal_iter_->current().key);
+            const auto ikey = internal_key_ref::parse(internal_iter_->current().key);
+            if (!upper_.empty() && ikey.user_key() >= upper_) {
+                out_of_bounds_ = true;
+                break;
+            }
             if (!ikey.is_deleted()) {
                 break;
             }
@@ -63,8 +110,33 @@ private:
         }
     }
 
+    // the upper bound itself may be found by seek_last
+    void skip_deleted_backward_()
+    {
+        out_of_bounds_ = false;
+        while (!internal_iter_->is_eof()) {
+            const auto ikey = internal_key_ref::parse(internal_iter_->current().key);
+            if (!lower_.empty() && ikey.user_key() < lower_) {
+                out_of_bounds_ = true;
+                break;
+            }
+            if (!ikey.is_deleted() && (upper_.empty() || ikey.user_key() < upper_)) {
+                break;
+            }
+
+            internal_iter_->prev();
+        }
+    }
+
 private:
     iter_ptr internal_iter_;
+    blob_store* const blobs_;
+    const bool verify_checksums_;
+    const std::string lower_;
+    const std::string upper_;
+
+    bool out_of_bounds_ = false;
+    std::string value_buf_;
 };
 
-}
\ No newline at end of file
+}
@@ -1,81 +1,177 @@
+#include <algorithm>
 #include <cassert>
+#include <string>
 #include "iterator/merge_iterator.h"
 
 using namespace cloudkv;
 
+merge_iterator::merge_iterator(std::vector<iter_ptr> iterators)
+    : iterators_(std::move(iterators)),
+      keys_(iterators_.size())
+{
+    heap_.reserve(iterators_.size());
+}
+
 void merge_iterator::seek_first()
 {
+    backward_ = false;
     for (auto& it: iterators_) {
         it->seek_first();
     }
 
-    update_current_();
+    rebuild_heap_();
 }
 
 void merge_iterator::seek(std::string_view key)
 {
+    backward_ = false;
     for (auto& it: iterators_) {
         it->seek(key);
     }
 
-    update_current_();
+    rebuild_heap_();
+}
+
+void merge_iterator::seek_last()
+{
+    backward_ = true;
+    for (auto& it: iterators_) {
+        it->seek_last();
+    }
+
+    rebuild_heap_();
+}
+
+void merge_iterator::seek_for_prev(std::string_view key)
+{
+    backward_ = true;
+    for (auto& it: iterators_) {
+        it->seek_for_prev(key);
+    }
+
+    rebuild_heap_();
 }
 
 bool merge_iterator::is_eof()
 {
-    return current_ == nullptr;
+    return heap_.empty();
 }
 
 void merge_iterator::next()
 {
     assert(!is_eof());
-    assert(current_);
 
-    for (auto& it: iterators_) {
-        if (it.get() == current_ || it->is_eof()) {
-            continue;
-        }
+    if (backward_) {
+        switch_direction_();
+    }
+    step_();
+}
+
+void merge_iterator::prev()
+{
+    assert(!is_eof());
+
+    if (!backward_) {
+        switch_direction_();
+    }
+    step_();
+}
+
+void merge_iterator::step_()
+{
+    const auto top = pop_();
+    const auto key = keys_[top];
+
+    // older versions of the same user key
+    while (!heap_.empty() && keys_[heap_.front()] == key) {
+        const auto i = pop_();
+        move_(i);
+        push_(i);
+    }
 
-        auto current = internal_key::parse(current_->current().key);
-        auto it_key = internal_key::parse(it->current().key);
-        if (current.user_key() == it_key.user_key()) {
-            it->next();
+    // last, key points into it
+    move_(top);
+    push_(top);
+}
+
+void merge_iterator::move_(std::size_t i)
+{
+    if (backward_) {
+        iterators_[i]->prev();
+    } else {
+        iterators_[i]->next();
+    }
+}
+
+// reposition children around the current key, at it if they have it
+void merge_iterator::switch_direction_()
+{
+    const std::string key(keys_[heap_.front()]);
+
+    backward_ = !backward_;
+    for (auto& it: iterators_) {
+        if (backward_) {
+            it->seek_for_prev(key);
+        } else {
+            it->seek(key);
         }
     }
 
-    current_->next();
-    update_current_();
+    rebuild_heap_();
 }
 
 merge_iterator::key_value_pair merge_iterator::current()
 {
-    assert(current_);
-    assert(!current_->is_eof());
-    return current_->current();
+    assert(!is_eof());
+    return iterators_[heap_.front()]->current();
 }
 
-void merge_iterator::update_current_()
+namespace {
+
+// whether child x comes after child y in the direction
+struct later_than {
+    const std::vector<user_key_ref>& keys;
+    const bool backward;
+
+    bool operator()(std::size_t x, std::size_t y) const
+    {
+        const auto r = backward? keys[y].compare(keys[x]): keys[x].compare(keys[y]);
+        return r > 0 || (r == 0 && x < y);
+    }
+};
+
+}
+
+void merge_iterator::push_(std::size_t i)
 {
-    kv_iter* smallest = nullptr;
+    const auto& it = iterators_[i];
+    if (it->is_eof()) {
+        return;
+    }
 
-    for (const auto& it: iterators_) {
-        if (it->is_eof()) {
-            continue;
-        }
+    keys_[i] = internal_key_ref::parse(it->current().key).user_key();
+    heap_.push_back(i);
+    std::push_heap(heap_.begin(), heap_.end(), later_than{ keys_, backward_ });
+}
 
-        if (!smallest) {
-            smallest = it.get();
-        } else {
-            // fixme
-            auto current = internal_key::parse(smallest->current().key);
-            auto it_key = internal_key::parse(it->current().key);
-
-            // for same value, we favor the later iterator
-            if (it_key.user_key() <= current.user_key()) {
-                smallest = it.get();
-            }
+std::size_t merge_iterator::pop_()
+{
+    std::pop_heap(heap_.begin(), heap_.end(), later_than{ keys_, backward_ });
+
+    const auto i = heap_.back();
+    heap_.pop_back();
+    return i;
+}
+
+void merge_iterator::rebuild_heap_()
+{
+    heap_.clear();
+    for (std::size_t i = 0; i < iterators_.size(); ++i) {
+        if (!iterators_[i]->is_eof()) {
+            keys_[i] = internal_key_ref::parse(iterators_[i]->current().key).user_key();
+            heap_.push_back(i);
         }
     }
 
-    current_ = smallest;
-}
\ No newline at end of file
+    std::make_heap(heap_.begin(), heap_.end(), later_than{ keys_, backward_ });
+}
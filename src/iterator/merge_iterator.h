@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <string_view>
 #include <vector>
 #include "cloudkv/iter.h"
 #include "kv_format.h"
@@ -7,35 +9,50 @@
 /**
  * @brief merge multiple internal iterators, eg. for compaction
  *
- * if multiple iterators have the same value, the iterator comes first win
+ * iterators come from the oldest to the newest, if multiple iterators have the same user key,
+ * the later one wins and the others are skipped
  *
- * for simplicity, use O(N) now
+ * children are kept in a binary heap on their user keys, so a step costs O(log N) comparisons
+ * of keys in place. moving backward keeps every child at its last key not greater than the current
+ * one, so switching direction seeks all children once
  */
 namespace cloudkv {
 
-// todo: use heap sort
 class merge_iterator : public kv_iter {
 public:
-    explicit merge_iterator(std::vector<iter_ptr> iterators)
-        : iterators_(std::move(iterators))
-    {}
+    explicit merge_iterator(std::vector<iter_ptr> iterators);
 
     void seek_first() override;
 
     void seek(std::string_view key) override;
 
+    void seek_last() override;
+    void seek_for_prev(std::string_view key) override;
+
     bool is_eof() override;
 
     void next() override;
+    void prev() override;
 
     key_value_pair current() override;
 
 private:
-    void update_current_();
+    // move the top and the children at the same user key in the current direction
+    void step_();
+    void move_(std::size_t i);
+    void switch_direction_();
+
+    // push child i into the heap unless it's eof
+    void push_(std::size_t i);
+    std::size_t pop_();
+
+    void rebuild_heap_();
 
 private:
     std::vector<iter_ptr> iterators_;
-    kv_iter* current_ = nullptr;
+    std::vector<user_key_ref> keys_;  // current user key of each child in heap
+    std::vector<std::size_t> heap_;   // the smallest key on top, the latest child for the same key
+    bool backward_ = false;           // the largest key on top instead
 };
 
-}
\ No newline at end of file
+}
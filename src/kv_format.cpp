@@ -3,18 +3,26 @@
 
 using namespace cloudkv;
 
-internal_key internal_key::parse(std::string_view key)
+internal_key_ref internal_key_ref::parse(std::string_view key)
 {
     if (key.size() <= 1) {
         throw data_corrupted{ "key is too small" };
     }
 
     const std::uint8_t keytype = key.back();
-    key.remove_suffix(1);
-
-    if (keytype > std::uint8_t(key_type::tombsome)) {
+    if (keytype > std::uint8_t(key_type::blob_index)) {
         throw data_corrupted{ "key type corrupted" };
     }
 
-    return { key, static_cast<key_type>(keytype) };
-}
\ No newline at end of file
+    return internal_key_ref(key);
+}
+
+internal_key internal_key::parse(std::string_view key)
+{
+    return internal_key(internal_key_ref::parse(key));
+}
+
+key_type cloudkv::extract_key_type(std::string_view ikey)
+{
+    return internal_key_ref::parse(ikey).type();
+}
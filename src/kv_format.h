@@ -11,7 +11,8 @@ using user_key_ref = std::string_view;
 
 enum class key_type : std::uint8_t {
     value,
-    tombsome
+    tombsome,
+    blob_index  // only in sstables, the value is a blob_ref to where the value is kept
 };
 
 inline void encode_internel_key(user_key_ref key, key_type op, std::string* buf)
@@ -25,6 +26,85 @@ inline void encode_internel_key(user_key_ref key, key_type op, std::string* buf)
     buf->push_back(static_cast<char>(op));
 }
 
+// user key part of an encoded internal key, the tag is not validated
+inline user_key_ref extract_user_key(std::string_view ikey)
+{
+    return ikey.substr(0, ikey.size() - 1);
+}
+
+// tag of an encoded internal key, throws data_corrupted if invalid
+key_type extract_key_type(std::string_view ikey);
+
+// view of an encoded internal key, which keeps valid as long as the bytes viewed
+class internal_key_ref {
+public:
+    internal_key_ref() = default;
+
+    // throws data_corrupted if invalid
+    static internal_key_ref parse(std::string_view buf);
+
+    user_key_ref user_key() const
+    {
+        return { ikey_.data(), ikey_.size() - 1 };
+    }
+
+    key_type type() const
+    {
+        return static_cast<key_type>(ikey_.back());
+    }
+
+    bool is_value() const
+    {
+        return type() == key_type::value;
+    }
+
+    bool is_deleted() const
+    {
+        return type() == key_type::tombsome;
+    }
+
+    bool is_blob_index() const
+    {
+        return type() == key_type::blob_index;
+    }
+
+    // by user keys, then by tags
+    int compare(internal_key_ref other) const
+    {
+        if (const auto r = user_key().compare(other.user_key()); r != 0) {
+            return r;
+        }
+
+        return static_cast<int>(type()) - static_cast<int>(other.type());
+    }
+
+    bool operator==(internal_key_ref other) const
+    {
+        return ikey_ == other.ikey_;
+    }
+
+    bool operator<(internal_key_ref other) const
+    {
+        return compare(other) < 0;
+    }
+
+    std::string_view underlying_key() const
+    {
+        return ikey_;
+    }
+
+private:
+    friend class internal_key;
+
+    explicit internal_key_ref(std::string_view ikey)
+        : ikey_(ikey)
+    {}
+
+private:
+    std::string_view ikey_;
+};
+
+// owns its bytes, only for keys kept
 class internal_key {
 public:
     internal_key() = default;
@@ -36,8 +116,18 @@ public:
         ikey_.push_back(static_cast<char>(type));
     }
 
+    explicit internal_key(internal_key_ref ref)
+        : ikey_(ref.underlying_key())
+    {}
+
     static internal_key parse(std::string_view buf);
 
+    // not for default constructed ones
+    internal_key_ref ref() const
+    {
+        return internal_key_ref(ikey_);
+    }
+
     user_key_ref user_key() const
     {
         return { ikey_.data(), ikey_.size() - 1 };
@@ -58,6 +148,11 @@ public:
         return type() == key_type::tombsome;
     }
 
+    bool is_blob_index() const
+    {
+        return type() == key_type::blob_index;
+    }
+
     bool operator==(const internal_key& other) const
     {
         return ikey_ == other.ikey_;
@@ -5,6 +5,7 @@
 using namespace std;
 using namespace cloudkv;
 
+// the skip list only links forward, backward moves go through an ordered snapshot of entries taken by the first one
 class memtable::memtable_iter : public kv_iter {
 public:
     explicit memtable_iter(memtable::accessor_t accessor)
@@ -13,34 +14,93 @@ public:
 
     void seek_first() override
     {
+        backward_ = false;
         iter_ = accessor_.begin();
     }
 
     void seek(std::string_view key) override
     {
+        backward_ = false;
         iter_ = accessor_.lower_bound(kv_entry(key));
     }
 
+    void seek_last() override
+    {
+        take_snapshot_();
+        pos_ = snapshot_.empty()? 0: snapshot_.size() - 1;
+    }
+
+    void seek_for_prev(std::string_view key) override
+    {
+        take_snapshot_();
+
+        const auto it = std::upper_bound(snapshot_.begin(), snapshot_.end(), key, [](user_key_ref k, const kv_entry* e) {
+            return k < e->user_key();
+        });
+        pos_ = it == snapshot_.begin()? snapshot_.size(): it - snapshot_.begin() - 1;
+    }
+
     bool is_eof() override
     {
-        return iter_ == accessor_.end();
+        return backward_? pos_ >= snapshot_.size(): iter_ == accessor_.end();
     }
 
     void next() override
     {
-        ++iter_;
+        assert(!is_eof());
+
+        if (backward_) {
+            ++pos_;
+        } else {
+            ++iter_;
+        }
+    }
+
+    void prev() override
+    {
+        assert(!is_eof());
+
+        if (!backward_) {
+            const auto key = iter_->user_key();
+            seek_for_prev(key);
+
+            // the current entry was added after the snapshot, the one found is before it
+            if (is_eof() || snapshot_[pos_]->user_key() != key) {
+                return;
+            }
+        }
+        pos_ = pos_ == 0? snapshot_.size(): pos_ - 1;
     }
 
     key_value_pair current() override
     {
         assert(!is_eof());
 
-        return { iter_->ikey.underlying_key(), iter_->value };
+        const auto& entry = backward_? *snapshot_[pos_]: *iter_;
+        return { entry.ikey.underlying_key(), entry.value };
+    }
+
+private:
+    // entries inserted later are not seen by backward moves
+    void take_snapshot_()
+    {
+        backward_ = true;
+        if (!snapshot_.empty()) {
+            return;
+        }
+
+        for (auto it = accessor_.begin(); it != accessor_.end(); ++it) {
+            snapshot_.push_back(&*it);
+        }
     }
 
 private:
     memtable::accessor_t accessor_;
     memtable::accessor_t::iterator iter_;
+
+    bool backward_ = false;
+    std::vector<const kv_entry*> snapshot_;
+    std::size_t pos_ = 0;
 };
 
 void memtable::add(key_type op, user_key_ref key, string_view value)
@@ -74,6 +134,24 @@ std::optional<internal_key_value> memtable::query(user_key_ref key)
     return {{ it->ikey, it->value }};
 }
 
+std::vector<std::optional<internal_key_value>> memtable::multi_query(const std::vector<user_key_ref>& keys)
+{
+    std::vector<std::optional<internal_key_value>> results;
+    results.reserve(keys.size());
+
+    accessor_t accessor(&map_);
+    for (const auto key: keys) {
+        auto it = accessor.find(kv_entry(key));
+        if (it == accessor.end()) {
+            results.emplace_back();
+        } else {
+            results.push_back(internal_key_value{ it->ikey, it->value });
+        }
+    }
+
+    return results;
+}
+
 iter_ptr memtable::iter()
 {
     return std::make_unique<memtable_iter>(accessor_t(&map_));
@@ -26,6 +26,9 @@ public:
 
     std::optional<internal_key_value> query(user_key_ref key);
 
+    // lookups sharing one accessor, results in the order of keys
+    std::vector<std::optional<internal_key_value>> multi_query(const std::vector<user_key_ref>& keys);
+
     iter_ptr iter();
 
     std::uint64_t logfile_id() const noexcept
@@ -1,5 +1,6 @@
 #include <cassert>
 #include <fmt/core.h>
+#include "util/crc32c.h"
 #include "util/format.h"
 #include "util/exception_util.h"
 #include "memtable/redolog.h"
@@ -21,7 +22,10 @@ redolog::redolog(const path_t& p, std::uint64_t buffer_size)
 
 void redolog::write(std::string_view record)
 {
-    PutFixed32(&buf_, record.size());
+    assert(record.size() < checksummed_flag);
+
+    PutFixed32(&buf_, record.size() | checksummed_flag);
+    PutFixed32(&buf_, crc32c::mask(crc32c::value(record)));
     buf_.append(record.begin(), record.end());
 
     out_.write(buf_.data(), buf_.size());
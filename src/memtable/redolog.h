@@ -7,8 +7,18 @@
 
 namespace cloudkv {
 
+/**
+ * record:
+ *  length  uint32_t, with checksummed_flag set
+ *  crc     uint32_t, masked crc32c of data
+ *  data
+ *
+ * records written before checksums have the flag cleared and no crc
+ */
 class redolog : noncopyable {
 public:
+    static constexpr std::uint32_t checksummed_flag = 1u << 31;
+
     explicit redolog(const path_t& p, std::uint64_t buffer_size = 4096);
 
     void write(std::string_view record);
@@ -1,13 +1,16 @@
 #include <cassert>
 #include "util/fmt_std.h"
+#include "util/crc32c.h"
 #include "util/format.h"
 #include "util/exception_util.h"
+#include "cloudkv/exception.h"
+#include "memtable/redolog.h"
 #include "memtable/redolog_reader.h"
 
 using namespace cloudkv;
 
 redolog_reader::redolog_reader(const path_t& p)
-    : ifs_(p, std::ios::binary)
+    : path_(p), ifs_(p, std::ios::binary)
 {
     if (!ifs_) {
         throw_system_error(fmt::format("open redolog {} failed", p));
@@ -25,11 +28,26 @@ std::optional<std::string_view> redolog_reader::next()
         return std::nullopt;
     }
 
+    std::uint32_t crc = 0;
+    const bool checksummed = record_size & redolog::checksummed_flag;
+    if (checksummed) {
+        record_size &= ~redolog::checksummed_flag;
+
+        ifs_.read(reinterpret_cast<char*>(&crc), sizeof(crc));
+        if (!ifs_) {
+            return std::nullopt;
+        }
+    }
+
     buf_.resize(record_size);
     ifs_.read(buf_.data(), buf_.size());
     if (!ifs_) {
         return std::nullopt;
     }
 
+    if (checksummed && crc32c::unmask(crc) != crc32c::value(buf_)) {
+        throw data_corrupted{ fmt::format("redolog {} corrupted at record of size {}", path_, record_size) };
+    }
+
     return buf_;
 }
\ No newline at end of file
@@ -13,11 +13,12 @@ class redolog_reader {
 public:
     explicit redolog_reader(const path_t& p);
 
-    // return nullopt if EOF
+    // return nullopt if EOF, throw data_corrupted if checksum mismatches
     // the return string_view keep valid until next call
     std::optional<std::string_view> next();
 
 private:
+    const path_t path_;
     std::ifstream ifs_;
     std::string buf_;
 };
@@ -1,6 +1,7 @@
 #include <fstream>
 #include <filesystem>
 #include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <scope_guard.hpp>
@@ -15,19 +16,37 @@ namespace fs = std::filesystem;
 
 namespace {
 
+struct raw_blob_file {
+    std::uint64_t file_id;
+    std::uint64_t total_bytes;
+    std::uint64_t discardable_bytes;
+
+    template<class Archive>
+    void serialize(Archive & ar, const unsigned int version)
+    {
+        (void)version;
+
+        ar & file_id;
+        ar & total_bytes;
+        ar & discardable_bytes;
+    }
+};
+
 struct raw_meta {
     std::uint64_t committed_file_id;
     std::uint64_t next_file_id;
     std::vector<std::string> sstables;
+    std::vector<raw_blob_file> blob_files;  // since version 1
 
     template<class Archive>
     void serialize(Archive & ar, const unsigned int version)
     {
-        (void)version;
-
         ar & committed_file_id;
         ar & next_file_id;
         ar & sstables;
+        if (version >= 1) {
+            ar & blob_files;
+        }
     }
 
     static raw_meta from_metainfo(const metainfo& info)
@@ -42,6 +61,9 @@ struct raw_meta {
         for (const auto& p: info.sstables) {
             raw.sstables.push_back(p->path());
         }
+        for (const auto& b: info.blob_files) {
+            raw.blob_files.push_back({ b.file_id, b.total_bytes, b.discardable_bytes });
+        }
 
         return raw;
     }
@@ -58,6 +80,9 @@ struct raw_meta {
         for (const auto& p: sstables) {
             m.sstables.push_back(std::make_shared<sstable>(p));
         }
+        for (const auto& b: blob_files) {
+            m.blob_files.push_back({ b.file_id, b.total_bytes, b.discardable_bytes });
+        }
 
         return m;
     }
@@ -65,6 +90,8 @@ struct raw_meta {
 
 }
 
+BOOST_CLASS_VERSION(raw_meta, 1)
+
 metainfo metainfo::load(const path_t& p)
 try {
     std::ifstream ifs(p);
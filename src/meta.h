@@ -4,6 +4,7 @@
 #include <string>
 #include "core.h"
 #include "sstable/sstable.h"
+#include "blob/blob_file.h"
 
 namespace cloudkv {
 
@@ -11,6 +12,7 @@ struct metainfo {
     std::uint64_t committed_file_id = 0;
     std::uint64_t next_file_id = 1;
     std::vector<sstable_ptr> sstables;
+    std::vector<blob_file_meta> blob_files;  // with values not yet all discardable
 
     static metainfo load(const path_t& p);
 
@@ -10,6 +10,7 @@ class path_conf {
     static constexpr std::string_view META_INFO = "meta";
     static constexpr std::string_view REDO_DIR = "redo";
     static constexpr std::string_view SST_DIR = "sst";
+    static constexpr std::string_view BLOB_DIR = "blob";
     static constexpr std::string_view LOCK_FILE = "lock";
 
 public:
@@ -18,7 +19,8 @@ public:
           lock_(p / LOCK_FILE),
           meta_info_(p / META_INFO),
           redo_dir_(p / REDO_DIR),
-          sst_dir_(p / SST_DIR)
+          sst_dir_(p / SST_DIR),
+          blob_dir_(p / BLOB_DIR)
     {}
 
     const path_t& root() const
@@ -46,6 +48,11 @@ public:
         return sst_dir_;
     }
 
+    const path_t& blob_dir() const
+    {
+        return blob_dir_;
+    }
+
     path_t redo_path(std::uint64_t file_id) const
     {
         return redo_dir() / std::to_string(file_id);
@@ -56,12 +63,18 @@ public:
         return sst_dir() / fmt::format("sst.{}", file_id);
     }
 
+    path_t blob_path(std::uint64_t file_id) const
+    {
+        return blob_dir() / fmt::format("blob.{}", file_id);
+    }
+
 private:
     const path_t db_path_;
     const path_t lock_;
     const path_t meta_info_;
     const path_t redo_dir_;
     const path_t sst_dir_;
+    const path_t blob_dir_;
 };
 
 }
\ No newline at end of file
@@ -61,7 +61,7 @@ replay_result replayer::replay()
     replay_result res = { committed_file_id_ };
 
     for (const auto& ctx: redolog_need_replay) {
-        auto sst = do_replay_(ctx.path);
+        auto sst = do_replay_(ctx.path, res.blob_files);
         if (!sst) {
             spdlog::warn("skip bad redo {}", ctx.path);
             continue;
@@ -73,7 +73,7 @@ replay_result replayer::replay()
     return res;
 }
 
-sstable_ptr replayer::do_replay_(const path_t& redopath)
+sstable_ptr replayer::do_replay_(const path_t& redopath, std::vector<blob_file_meta>& blob_files)
 {
     gc_root gc;
     redolog_reader reader(redopath);
@@ -93,11 +93,13 @@ sstable_ptr replayer::do_replay_(const path_t& redopath)
     sstable_ptr result;
     checkpoint_task({
         db_path_,
+        opts_,
         file_id_alloc_,
         gc,
         std::move(mt),
-        [&result](const auto& sst){
+        [&result, &blob_files](const auto& sst, const auto& blobs){
             result = sst;
+            blob_files.insert(blob_files.end(), blobs.begin(), blobs.end());
         }
     }).run();
 
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "sstable/sstable.h"
+#include "blob/blob_file.h"
 #include "path_conf.h"
+#include "cloudkv/options.h"
 #include "file_id_allocator.h"
 #include "gc_root.h"
 
@@ -10,12 +12,14 @@ namespace cloudkv {
 struct replay_result {
     std::uint64_t replayed_file_id;
     std::vector<sstable_ptr> sstables;
+    std::vector<blob_file_meta> blob_files;
 };
 
 class replayer {
 public:
-    replayer(const path_conf& db, file_id_allocator& id_alloc, std::uint64_t committed_file_id)
+    replayer(const path_conf& db, const options& opts, file_id_allocator& id_alloc, std::uint64_t committed_file_id)
         : db_path_(db),
+          opts_(opts),
           file_id_alloc_(id_alloc),
           committed_file_id_(committed_file_id)
     {
@@ -24,10 +28,12 @@ public:
     replay_result replay();
 
 private:
-    sstable_ptr do_replay_(const path_t& p);
+    // blob files written are appended to blob_files
+    sstable_ptr do_replay_(const path_t& p, std::vector<blob_file_meta>& blob_files);
 
 private:
     const path_conf& db_path_;
+    const options& opts_;
     file_id_allocator& file_id_alloc_;
     const std::uint64_t committed_file_id_;
 };
@@ -0,0 +1,62 @@
+#include "row_cache.h"
+#include "util/hash.h"
+
+using namespace cloudkv;
+
+namespace {
+
+// bookkeeping of lru entries, roughly
+constexpr std::uint64_t row_overhead = 96;
+
+}
+
+row_cache::row_cache(std::uint64_t capacity_in_bytes)
+    : cache_(capacity_in_bytes)
+{
+}
+
+row_cache::row_ptr row_cache::find(user_key_ref key)
+{
+    auto r = cache_.find(key);
+    (r? hits_: misses_).fetch_add(1, std::memory_order_relaxed);
+
+    return r;
+}
+
+std::uint64_t row_cache::version(user_key_ref key) const
+{
+    return versions_[slot_(key)].load();
+}
+
+void row_cache::insert(user_key_ref key, std::uint64_t version, std::optional<std::string_view> value)
+{
+    const auto& v = versions_[slot_(key)];
+    if (v.load() != version) {
+        return;
+    }
+
+    auto r = std::make_shared<row>();
+    r->deleted = !value;
+    if (value) {
+        r->value = *value;
+    }
+
+    const auto charge = key.size() + r->value.size() + row_overhead;
+    cache_.insert(std::string(key), std::move(r), charge);
+
+    // raced with a write, which may have invalidated the key before the insert
+    if (v.load() != version) {
+        cache_.erase(key);
+    }
+}
+
+void row_cache::invalidate(user_key_ref key)
+{
+    versions_[slot_(key)].fetch_add(1);
+    cache_.erase(key);
+}
+
+std::size_t row_cache::slot_(user_key_ref key)
+{
+    return Hash(key.data(), key.size(), 0) % version_count;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "core.h"
+#include "kv_format.h"
+#include "util/lru_cache.h"
+
+namespace cloudkv {
+
+/**
+ * @brief latest values of user keys found in sstables, charged by key and value size
+ *
+ * writes invalidate their keys after they are applied to the memtable. each key maps to one of
+ * a fixed set of versions bumped by invalidations, taken by readers before their lookups, so values
+ * looked up before a concurrent write are never left in cache
+ *
+ * thread safe
+ */
+class row_cache : private noncopyable {
+public:
+    struct row {
+        bool deleted = false;
+        std::string value;
+    };
+    using row_ptr = std::shared_ptr<const row>;
+
+    explicit row_cache(std::uint64_t capacity_in_bytes);
+
+    // return nullptr if not cached, counted as a hit or a miss
+    row_ptr find(user_key_ref key);
+
+    // taken before looking the key up to fill the cache
+    std::uint64_t version(user_key_ref key) const;
+
+    // nullopt value for deleted keys, dropped if key was invalidated since version
+    void insert(user_key_ref key, std::uint64_t version, std::optional<std::string_view> value);
+
+    void invalidate(user_key_ref key);
+
+    std::uint64_t hits() const
+    {
+        return hits_.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t misses() const
+    {
+        return misses_.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t bytes_used()
+    {
+        return cache_.total_charge();
+    }
+
+private:
+    static constexpr std::size_t version_count = 4096;
+
+    static std::size_t slot_(user_key_ref key);
+
+private:
+    lru_cache<std::string, row> cache_;
+    std::array<std::atomic_uint64_t, version_count> versions_ {};
+
+    std::atomic_uint64_t hits_ { 0 };
+    std::atomic_uint64_t misses_ { 0 };
+};
+
+}
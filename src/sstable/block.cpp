@@ -1,18 +1,34 @@
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include "cloudkv/exception.h"
 #include "util/fmt_std.h"
 #include "util/coding.h"
+#include "util/hash.h"
 #include "sstable/format.h"
+#include "sstable/block_builder.h"
+#include "kv_format.h"
 #include "block.h"
 
 using namespace cloudkv;
 
 namespace {
 
-std::uint32_t parse_count(std::string_view buf)
+constexpr auto u32_size = sizeof(std::uint32_t);
+
+std::uint64_t load_key_head(const char* p)
 {
-    const auto u32_size = sizeof(std::uint32_t);
+    std::uint64_t head;
+    std::memcpy(&head, p, sizeof(head));
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    head = __builtin_bswap64(head);
+#endif
+    return head;
+}
 
+std::uint32_t parse_trailer(std::string_view buf)
+{
     if (buf.size() < u32_size) {
         throw data_corrupted{ fmt::format("invalid block length: {}", buf.size()) };
     }
@@ -20,28 +36,67 @@ std::uint32_t parse_count(std::string_view buf)
     return DecodeFixed32(buf.data() + buf.size() - u32_size);
 }
 
-class block_iter : public kv_iter {
+sst::block_format parse_format(std::string_view buf)
+{
+    const auto format = parse_trailer(buf) >> 24;
+    switch (format & ~sst::block_key_heads_flag) {
+    case static_cast<std::uint32_t>(sst::block_format::flat):
+        if (format != static_cast<std::uint32_t>(sst::block_format::flat)) {
+            throw data_corrupted{ fmt::format("unknown block format {}", format) };
+        }
+        return sst::block_format::flat;
+
+    case static_cast<std::uint32_t>(sst::block_format::prefix):
+    case static_cast<std::uint32_t>(sst::block_format::prefix_hash):
+        return static_cast<sst::block_format>(format & ~sst::block_key_heads_flag);
+
+    default:
+        throw data_corrupted{ fmt::format("unknown block format {}", format) };
+    }
+}
+
+// entries and offset table of a flat block
+class flat_layout {
 public:
-    block_iter(std::string_view buf, std::uint32_t count)
+    // buf without the trailing count
+    flat_layout(std::string_view buf, std::uint32_t count)
         : buf_(buf),
           count_(count),
-          offset_table_(buf_.data() + buf_.size() - count_ * sizeof(std::uint32_t))
+          offset_table_(buf_.data() + buf_.size() - count_ * u32_size)
     {
-        assert(buf_.size() >= count_ * sizeof(std::uint32_t));
+        assert(buf_.size() >= count_ * u32_size);
     }
 
-    void seek_first() override
+    static flat_layout from_content(std::string_view content)
     {
-        seek_to_index_(0);
+        const auto count = parse_trailer(content);
+        if (content.size() < (count + 1) * u32_size) {
+            throw data_corrupted{ fmt::format("block corrupted, {} keys with only size {}", count, content.size()) };
+        }
+
+        content.remove_suffix(u32_size);
+        return { content, count };
     }
 
-    void seek(std::string_view key) override
+    std::uint32_t count() const
     {
-        std::uint32_t first = 0;
-        std::uint32_t last = count_;
+        return count_;
+    }
+
+    // index of the first key not less than key
+    std::uint32_t lower_bound(std::string_view key) const
+    {
+        return lower_bound(key, 0, count_);
+    }
+
+    // same as above, with the result known to be in [first, last]
+    std::uint32_t lower_bound(std::string_view key, std::uint32_t first, std::uint32_t last) const
+    {
+        assert(first <= last && last <= count_);
+
         while (first != last) {
             const auto mid = first + (last - first) / 2;
-            const auto key_at_mid = get_key(mid);
+            const auto key_at_mid = key_at(mid);
             if (key_at_mid < key) {
                 first = mid + 1;
             } else {
@@ -49,26 +104,43 @@ public:
             }
         }
 
-        seek_to_index_(first);
+        return first;
     }
 
-    bool is_eof() override
+    kv_iter::key_value_pair entry(std::uint32_t idx) const
     {
-        return idx_ == count_;
-    }
+        assert(idx < count_);
 
-    void next() override
-    {
-        assert(!is_eof());
-        seek_to_index_(idx_ + 1);
+        kv_iter::key_value_pair kv;
+        try {
+            const auto offset = get_offset_(idx);
+            std::string_view kvbuf = buf_.substr(offset);
+
+            kvbuf = decode_str(kvbuf, &kv.key);
+            kvbuf = decode_str(kvbuf, &kv.value);
+
+            if (kvbuf.data() > offset_table_) {
+                throw data_corrupted{ fmt::format("block corrupted when read index {}", idx) };
+            }
+        } catch (std::invalid_argument&) {
+            throw data_corrupted{ fmt::format("block corrupted when read index {}", idx) };
+        }
+
+        return kv;
     }
 
-    key_value_pair current() override
+    std::string_view key_at(std::uint32_t idx) const
     {
-        assert(!is_eof());
-        assert(!current_key_.empty());
+        assert(idx < count_);
+
+        try {
+            auto offset = get_offset_(idx);
+            auto kv = buf_.substr(offset);
 
-        return { current_key_, current_value_ };
+            return decode_str(kv);
+        } catch (std::invalid_argument&) {
+            throw data_corrupted{ fmt::format("invalid key to decode in idx {}", idx) };
+        }
     }
 
 private:
@@ -76,70 +148,676 @@ private:
     {
         assert(idx <= count_);
 
-        return DecodeFixed32(offset_table_ + idx * sizeof(std::uint32_t));
+        return DecodeFixed32(offset_table_ + idx * u32_size);
+    }
+
+private:
+    const std::string_view buf_;
+    const std::uint32_t count_;
+    const char* offset_table_;
+};
+
+// 8 bytes of key following skip, zero padded, compared as a big endian integer
+std::uint64_t key_head(std::string_view key, std::uint32_t skip)
+{
+    char buf[sst::block_key_head_size] = {};
+    if (key.size() > skip) {
+        std::memcpy(buf, key.data() + skip, std::min<std::size_t>(key.size() - skip, sizeof(buf)));
     }
 
-    std::string_view get_key(std::uint32_t idx) const
+    return load_key_head(buf);
+}
+
+// entries, restart points, optional key heads and hash index of a prefix compressed block
+class prefix_layout {
+public:
+    static prefix_layout from_content(std::string_view content)
     {
-        assert(idx < count_);
+        const auto trailer = parse_trailer(content);
+        const auto restart_count = trailer & 0xffffff;
+        if (content.size() < 2 * u32_size + std::uint64_t(restart_count) * u32_size) {
+            throw data_corrupted{ fmt::format("block corrupted, {} restarts with only size {}", restart_count, content.size()) };
+        }
 
-        auto offset = get_offset_(idx);
-        auto kv = buf_.substr(offset);
+        content.remove_suffix(u32_size);
+        const auto count = DecodeFixed32(content.data() + content.size() - u32_size);
+        content.remove_suffix(u32_size);
 
-        try {
-            return decode_str(kv);
-        } catch (std::invalid_argument&) {
-            throw data_corrupted{ fmt::format("invalid key to decode in idx {}", idx) };
+        std::string_view buckets;
+        if (((trailer >> 24) & ~sst::block_key_heads_flag) == static_cast<std::uint32_t>(sst::block_format::prefix_hash)) {
+            if (content.size() < u32_size) {
+                throw data_corrupted{ "block corrupted, no hash buckets" };
+            }
+
+            const auto bucket_count = DecodeFixed32(content.data() + content.size() - u32_size);
+            content.remove_suffix(u32_size);
+            if (bucket_count == 0 || content.size() < bucket_count + std::uint64_t(restart_count) * u32_size) {
+                throw data_corrupted{ fmt::format("block corrupted, {} buckets with only size {}", bucket_count, content.size()) };
+            }
+
+            buckets = content.substr(content.size() - bucket_count);
+            content.remove_suffix(bucket_count);
+        }
+
+        content.remove_suffix(restart_count * u32_size);
+        const char* restarts = content.data() + content.size();
+
+        const char* heads = nullptr;
+        std::uint32_t head_skip = 0;
+        if ((trailer >> 24) & sst::block_key_heads_flag) {
+            const auto heads_size = std::uint64_t(restart_count) * sst::block_key_head_size;
+            if (content.size() < heads_size + u32_size) {
+                throw data_corrupted{ fmt::format("block corrupted, {} key heads with only size {}", restart_count, content.size()) };
+            }
+
+            content.remove_suffix(heads_size);
+            heads = content.data() + content.size();
+            head_skip = DecodeFixed32(heads - u32_size);
+            content.remove_suffix(u32_size);
+        }
+
+        return prefix_layout(content, count, restart_count, restarts, buckets, heads, head_skip);
+    }
+
+    std::uint32_t count() const
+    {
+        return count_;
+    }
+
+    std::uint32_t restart_count() const
+    {
+        return restart_count_;
+    }
+
+    std::uint32_t restart_offset(std::uint32_t idx) const
+    {
+        assert(idx < restart_count_);
+
+        const auto offset = DecodeFixed32(restarts_ + idx * u32_size);
+        if (offset > entries_.size()) {
+            throw data_corrupted{ fmt::format("block corrupted, invalid restart {} at {}", offset, idx) };
+        }
+
+        return offset;
+    }
+
+    struct entry_header {
+        std::uint32_t shared;
+        std::uint32_t unshared;
+        std::uint32_t value_length;
+        const char* delta;  // followed by the value
+    };
+
+    entry_header decode(std::uint32_t offset) const
+    {
+        assert(offset < entries_.size());
+
+        const char* p = entries_.data() + offset;
+        const char* limit = entries_.data() + entries_.size();
+
+        entry_header h;
+        if ((p = GetVarint32Ptr(p, limit, &h.shared)) == nullptr ||
+            (p = GetVarint32Ptr(p, limit, &h.unshared)) == nullptr ||
+            (p = GetVarint32Ptr(p, limit, &h.value_length)) == nullptr ||
+            std::uint64_t(limit - p) < std::uint64_t(h.unshared) + h.value_length) {
+            throw data_corrupted{ fmt::format("block corrupted when read offset {}", offset) };
         }
+
+        h.delta = p;
+        return h;
+    }
+
+    std::uint32_t offset_of(const char* p) const
+    {
+        return p - entries_.data();
+    }
+
+    std::uint32_t entries_size() const
+    {
+        return entries_.size();
+    }
+
+    bool has_hash_index() const
+    {
+        return !buckets_.empty();
+    }
+
+    bool has_key_heads() const
+    {
+        return heads_ != nullptr;
+    }
+
+    std::uint32_t head_skip() const
+    {
+        return head_skip_;
+    }
+
+    std::uint64_t key_head(std::uint32_t idx) const
+    {
+        assert(has_key_heads());
+        assert(idx < restart_count_);
+
+        return load_key_head(heads_ + idx * sst::block_key_head_size);
+    }
+
+    // restart where the user key can only be, or empty_bucket/collided_bucket
+    std::uint8_t bucket_of(std::string_view user_key) const
+    {
+        assert(has_hash_index());
+
+        const auto hash = Hash(user_key.data(), user_key.size(), sst::block_hash_seed);
+        return static_cast<std::uint8_t>(buckets_[hash % buckets_.size()]);
+    }
+
+private:
+    prefix_layout(std::string_view entries, std::uint32_t count, std::uint32_t restart_count, const char* restarts,
+                  std::string_view buckets, const char* heads, std::uint32_t head_skip)
+        : entries_(entries), count_(count), restart_count_(restart_count), restarts_(restarts),
+          buckets_(buckets), heads_(heads), head_skip_(head_skip)
+    {
+    }
+
+private:
+    std::string_view entries_;
+    std::uint32_t count_;
+    std::uint32_t restart_count_;
+    const char* restarts_;
+    std::string_view buckets_;
+    const char* heads_;
+    std::uint32_t head_skip_;
+};
+
+// cursors walk a block in key order, key buffers are only used by formats storing partial keys
+class flat_cursor {
+public:
+    flat_cursor(flat_layout layout, std::string*)
+        : layout_(layout)
+    {
+    }
+
+    void seek_first()
+    {
+        seek_to_index_(0);
+    }
+
+    void seek(std::string_view key)
+    {
+        seek_to_index_(layout_.lower_bound(key));
     }
 
+    // search entries [first, last] before the whole block
+    void seek(std::string_view key, std::uint32_t first, std::uint32_t last)
+    {
+        const auto count = layout_.count();
+        first = std::min(first, count);
+        last = std::clamp(last, first, count);
+        if ((first > 0 && !(layout_.key_at(first - 1) < key)) || (last < count && layout_.key_at(last) < key)) {
+            seek(key);
+            return;
+        }
+
+        seek_to_index_(layout_.lower_bound(key, first, last));
+    }
+
+    bool valid() const
+    {
+        return idx_ < layout_.count();
+    }
+
+    void seek_last()
+    {
+        seek_to_index_(layout_.count() == 0? 0: layout_.count() - 1);
+    }
+
+    void next()
+    {
+        assert(valid());
+        seek_to_index_(idx_ + 1);
+    }
+
+    void prev()
+    {
+        assert(valid());
+        seek_to_index_(idx_ == 0? layout_.count(): idx_ - 1);
+    }
+
+    kv_iter::key_value_pair current() const
+    {
+        return current_;
+    }
+
+private:
     void seek_to_index_(std::uint32_t idx)
     {
-        assert(idx <= count_);
+        assert(idx <= layout_.count());
 
         idx_ = idx;
-        if (idx_ == count_) {
+        if (valid()) {
+            current_ = layout_.entry(idx_);
+        }
+    }
+
+private:
+    const flat_layout layout_;
+    std::uint32_t idx_ = 0;
+
+    kv_iter::key_value_pair current_;
+};
+
+class prefix_cursor {
+public:
+    prefix_cursor(prefix_layout layout, std::string* key)
+        : layout_(layout), key_(key)
+    {
+        assert(key_);
+    }
+
+    void seek_first()
+    {
+        seek_to_restart_(0);
+        parse_next_();
+    }
+
+    void seek(std::string_view key)
+    {
+        if (layout_.count() == 0) {
+            seek_to_restart_(layout_.restart_count());
             return;
         }
 
-        try {
-            const auto offset = get_offset_(idx_);
-            std::string_view kvbuf = buf_.substr(offset);
+        // keys at restart points are stored in full, find the last one less than key
+        const auto first = layout_.has_key_heads()?
+            restart_lower_bound_by_heads_(key): restart_lower_bound_(key, 0, layout_.restart_count());
 
-            kvbuf = decode_str(kvbuf, &current_key_);
-            kvbuf = decode_str(kvbuf, &current_value_);
+        seek_in_restart_(key, first);
+    }
 
-            if (kvbuf.data() > offset_table_) {
-                throw data_corrupted{ fmt::format("block corrupted when read index {}", idx_ - 1) };
+    // search restarts [first, last] before the whole block
+    void seek(std::string_view key, std::uint32_t first, std::uint32_t last)
+    {
+        const auto restart_count = layout_.restart_count();
+        first = std::min(first, restart_count);
+        last = std::clamp(last, first, restart_count);
+        if (layout_.count() == 0 ||
+            (first > 0 && !(restart_key_(first - 1) < key)) ||
+            (last < restart_count && restart_key_(last) < key)) {
+            seek(key);
+            return;
+        }
+
+        seek_in_restart_(key, restart_lower_bound_(key, first, last));
+    }
+
+    // position at the first entry of the restart
+    void seek_to_restart(std::uint32_t idx)
+    {
+        if (idx >= layout_.restart_count()) {
+            throw data_corrupted{ fmt::format("block corrupted, invalid restart index {}", idx) };
+        }
+
+        seek_to_restart_(idx);
+        parse_next_();
+    }
+
+    bool valid() const
+    {
+        return valid_;
+    }
+
+    void seek_last()
+    {
+        seek_to_restart_(layout_.restart_count() == 0? 0: layout_.restart_count() - 1);
+        while (parse_next_() && next_ < layout_.entries_size()) {
+        }
+    }
+
+    void next()
+    {
+        assert(valid());
+        parse_next_();
+    }
+
+    // entries only decode forward, so rescan from the last restart before the current one
+    void prev()
+    {
+        assert(valid());
+
+        const auto original = current_;
+        if (original == 0) {
+            seek_to_restart_(layout_.restart_count());
+            return;
+        }
+
+        seek_to_restart_(restart_before_(original));
+        while (parse_next_() && next_ < original) {
+        }
+    }
+
+    kv_iter::key_value_pair current() const
+    {
+        return { *key_, value_ };
+    }
+
+private:
+    // entries before the first restart whose key is not less than key are in the previous restart
+    void seek_in_restart_(std::string_view key, std::uint32_t first)
+    {
+        seek_to_restart_(first == 0? 0: first - 1);
+        while (parse_next_() && std::string_view(*key_) < key) {
+        }
+    }
+
+    // first restart whose key is not less than key, known to be in [first, last]
+    std::uint32_t restart_lower_bound_(std::string_view key, std::uint32_t first, std::uint32_t last) const
+    {
+        while (first != last) {
+            const auto mid = first + (last - first) / 2;
+            if (restart_key_(mid) < key) {
+                first = mid + 1;
+            } else {
+                last = mid;
             }
-        } catch (std::invalid_argument&) {
-            throw data_corrupted{ fmt::format("block corrupted when read index {}", idx_ - 1) };
         }
+
+        return first;
+    }
+
+    // same as above, decoding restart keys only when heads tie
+    std::uint32_t restart_lower_bound_by_heads_(std::string_view key) const
+    {
+        // keys not sharing the prefix of the block are out of its range
+        const auto skip = layout_.head_skip();
+        const auto prefix = restart_key_(0).substr(0, skip);
+        const auto r = key.substr(0, skip).compare(prefix);
+        if (r < 0) {
+            return 0;
+        }
+        if (r > 0) {
+            return layout_.restart_count();
+        }
+
+        const auto head = key_head(key, skip);
+
+        std::uint32_t first = 0;
+        std::uint32_t last = layout_.restart_count();
+        while (first != last) {
+            const auto mid = first + (last - first) / 2;
+            const auto head_at_mid = layout_.key_head(mid);
+            if (head_at_mid < head || (head_at_mid == head && restart_key_(mid) < key)) {
+                first = mid + 1;
+            } else {
+                last = mid;
+            }
+        }
+
+        return first;
+    }
+
+    // last restart whose offset is less than offset, which is positive
+    std::uint32_t restart_before_(std::uint32_t offset) const
+    {
+        std::uint32_t first = 0;
+        std::uint32_t last = layout_.restart_count();
+        while (first != last) {
+            const auto mid = first + (last - first) / 2;
+            if (layout_.restart_offset(mid) < offset) {
+                first = mid + 1;
+            } else {
+                last = mid;
+            }
+        }
+
+        if (first == 0) {
+            throw data_corrupted{ fmt::format("block corrupted, no restart before offset {}", offset) };
+        }
+        return first - 1;
+    }
+
+    std::string_view restart_key_(std::uint32_t idx) const
+    {
+        const auto offset = layout_.restart_offset(idx);
+        if (offset == layout_.entries_size()) {
+            throw data_corrupted{ fmt::format("block corrupted, empty restart {}", idx) };
+        }
+
+        const auto h = layout_.decode(offset);
+        if (h.shared != 0) {
+            throw data_corrupted{ fmt::format("block corrupted, restart {} shares prefix", idx) };
+        }
+
+        return { h.delta, h.unshared };
+    }
+
+    void seek_to_restart_(std::uint32_t idx)
+    {
+        key_->clear();
+        valid_ = false;
+        next_ = idx < layout_.restart_count()? layout_.restart_offset(idx): layout_.entries_size();
+    }
+
+    bool parse_next_()
+    {
+        if (next_ >= layout_.entries_size()) {
+            valid_ = false;
+            return false;
+        }
+
+        const auto h = layout_.decode(next_);
+        if (h.shared > key_->size()) {
+            throw data_corrupted{ fmt::format("block corrupted when read offset {}", next_) };
+        }
+
+        key_->resize(h.shared);
+        key_->append(h.delta, h.unshared);
+        value_ = { h.delta + h.unshared, h.value_length };
+        current_ = next_;
+        next_ = layout_.offset_of(value_.data() + value_.size());
+        valid_ = true;
+
+        return true;
     }
 
 private:
-    const std::string_view buf_;
-    const std::uint32_t count_;
-    const char* offset_table_;
-    std::uint32_t idx_ = 0;
+    const prefix_layout layout_;
+    std::string* const key_;
 
-    std::string_view current_key_;
-    std::string_view current_value_;
+    std::uint32_t current_ = 0;
+    std::uint32_t next_ = 0;
+    bool valid_ = false;
+    std::string_view value_;
 };
 
+template <class Cursor>
+class block_iter : public kv_iter {
+public:
+    template <class Layout>
+    explicit block_iter(Layout layout)
+        : cursor_(layout, &key_)
+    {
+    }
+
+    void seek_first() override
+    {
+        cursor_.seek_first();
+    }
+
+    void seek(std::string_view key) override
+    {
+        cursor_.seek(key);
+    }
+
+    void seek_last() override
+    {
+        cursor_.seek_last();
+    }
+
+    // keys are internal ones, the entry of the user key itself sorts after it
+    void seek_for_prev(std::string_view key) override
+    {
+        cursor_.seek(key);
+        if (!cursor_.valid()) {
+            cursor_.seek_last();
+        } else if (extract_user_key(cursor_.current().key) != key) {
+            cursor_.prev();
+        }
+    }
+
+    bool is_eof() override
+    {
+        return !cursor_.valid();
+    }
+
+    void next() override
+    {
+        assert(!is_eof());
+        cursor_.next();
+    }
+
+    void prev() override
+    {
+        assert(!is_eof());
+        cursor_.prev();
+    }
+
+    key_value_pair current() override
+    {
+        assert(!is_eof());
+
+        const auto kv = cursor_.current();
+        assert(!kv.key.empty());
+
+        return kv;
+    }
+
+private:
+    std::string key_;
+    Cursor cursor_;
+};
+
+template <class Cursor, class Layout, class... Window>
+std::optional<kv_iter::key_value_pair> find(Layout layout, std::string_view key, std::string* scratch, Window... window)
+{
+    Cursor cursor(layout, scratch);
+
+    cursor.seek(key, window...);
+    if (!cursor.valid()) {
+        return std::nullopt;
+    }
+
+    return cursor.current();
+}
+
+// entry of user key in a block of internal keys
+template <class Cursor, class Layout>
+std::optional<kv_iter::key_value_pair> find_user_key(Layout layout, std::string_view user_key, std::string* scratch)
+{
+    const auto r = find<Cursor>(layout, user_key, scratch);
+    if (!r || extract_user_key(r->key) != user_key) {
+        return std::nullopt;
+    }
+
+    return r;
+}
+
+// scan the only restart the user key can be in, falling back to binary search on collision
+std::optional<kv_iter::key_value_pair> find_user_key_hashed(prefix_layout layout, std::string_view user_key, std::string* scratch)
+{
+    const auto restart = layout.bucket_of(user_key);
+    if (restart == block_builder::empty_bucket) {
+        return std::nullopt;
+    }
+    if (restart == block_builder::collided_bucket) {
+        return find_user_key<prefix_cursor>(layout, user_key, scratch);
+    }
+
+    prefix_cursor cursor(layout, scratch);
+    for (cursor.seek_to_restart(restart); cursor.valid(); cursor.next()) {
+        const auto kv = cursor.current();
+        const auto key = extract_user_key(kv.key);
+        if (key == user_key) {
+            return kv;
+        }
+        if (key > user_key) {
+            break;
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::uint32_t entry_count(std::string_view buf)
+{
+    if (parse_format(buf) == sst::block_format::flat) {
+        return flat_layout::from_content(buf).count();
+    }
+
+    return prefix_layout::from_content(buf).count();
+}
+
 }
 
 block::block(std::string_view buf)
-    : buf_(buf), count_(parse_count(buf))
+    : block(std::string(buf))
+{
+}
+
+block::block(std::string&& buf)
+    : owned_buf_(std::move(buf)), buf_(owned_buf_), count_(entry_count(buf_))
+{
+}
+
+block::block(std::string_view buf, std::shared_ptr<const void> owner)
+    : owner_(std::move(owner)), buf_(buf), count_(entry_count(buf_))
 {
-    if (buf_.size() < count_ * sizeof(std::uint32_t)) {
-        throw data_corrupted{ fmt::format("block corrupted, {} keys with only size {}", count_, buf_.size()) };
+}
+
+iter_ptr block::iter() const
+{
+    if (parse_format(buf_) == sst::block_format::flat) {
+        return std::make_unique<block_iter<flat_cursor>>(flat_layout::from_content(buf_));
+    }
+
+    return std::make_unique<block_iter<prefix_cursor>>(prefix_layout::from_content(buf_));
+}
+
+std::optional<kv_iter::key_value_pair> block::lower_bound(std::string_view key, std::string* scratch) const
+{
+    return lower_bound(buf_, key, scratch);
+}
+
+std::optional<kv_iter::key_value_pair> block::lower_bound(std::string_view content, std::string_view key, std::string* scratch)
+{
+    if (parse_format(content) == sst::block_format::flat) {
+        return find<flat_cursor>(flat_layout::from_content(content), key, scratch);
     }
+
+    return find<prefix_cursor>(prefix_layout::from_content(content), key, scratch);
 }
 
-iter_ptr block::iter()
+std::optional<kv_iter::key_value_pair> block::get(std::string_view user_key, std::string* scratch) const
 {
-    std::string_view buf = buf_;
-    buf.remove_suffix(sizeof(std::uint32_t));
-    return std::make_unique<block_iter>(buf, count_);
-}
\ No newline at end of file
+    return get(buf_, user_key, scratch);
+}
+
+std::optional<kv_iter::key_value_pair> block::get(std::string_view content, std::string_view user_key, std::string* scratch)
+{
+    if (parse_format(content) == sst::block_format::flat) {
+        return find_user_key<flat_cursor>(flat_layout::from_content(content), user_key, scratch);
+    }
+
+    const auto layout = prefix_layout::from_content(content);
+    if (layout.has_hash_index()) {
+        return find_user_key_hashed(layout, user_key, scratch);
+    }
+
+    return find_user_key<prefix_cursor>(layout, user_key, scratch);
+}
+
+std::optional<kv_iter::key_value_pair> block::lower_bound(std::string_view key, std::string* scratch, std::uint32_t first, std::uint32_t last) const
+{
+    if (parse_format(buf_) == sst::block_format::flat) {
+        return find<flat_cursor>(flat_layout::from_content(buf_), key, scratch, first, last);
+    }
+
+    return find<prefix_cursor>(prefix_layout::from_content(buf_), key, scratch, first, last);
+}
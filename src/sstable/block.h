@@ -1,6 +1,9 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
 #include "cloudkv/iter.h"
 
 namespace cloudkv {
@@ -9,16 +12,48 @@ class block {
 public:
     explicit block(std::string_view buf);
 
-    iter_ptr iter();
+    // take the buffer over without copying
+    explicit block(std::string&& buf);
+
+    // refer to buf without copying, owner keeps buf alive
+    block(std::string_view buf, std::shared_ptr<const void> owner);
+
+    iter_ptr iter() const;
+
+    // first entry not less than key, searched in place without building iterators
+    // prefix compressed keys are rebuilt in scratch, the result may point to it
+    std::optional<kv_iter::key_value_pair> lower_bound(std::string_view key, std::string* scratch) const;
+
+    // same as above, on raw block content
+    static std::optional<kv_iter::key_value_pair> lower_bound(std::string_view content, std::string_view key, std::string* scratch);
+
+    // same as above, searching restart points [first, last] first, which are entries for blocks restarting at each
+    // predictions missing the result only cost a search of the whole block
+    std::optional<kv_iter::key_value_pair> lower_bound(std::string_view key, std::string* scratch, std::uint32_t first, std::uint32_t last) const;
+
+    // entry of user key in a block of internal keys, probing the hash index if the block has one
+    std::optional<kv_iter::key_value_pair> get(std::string_view user_key, std::string* scratch) const;
+
+    // same as above, on raw block content
+    static std::optional<kv_iter::key_value_pair> get(std::string_view content, std::string_view user_key, std::string* scratch);
 
     int count() const
     {
         return count_;
     }
 
+    std::uint64_t size_in_bytes() const
+    {
+        return buf_.size();
+    }
+
 private:
-    const std::string buf_;
+    const std::string owned_buf_;
+    const std::shared_ptr<const void> owner_;
+    const std::string_view buf_;
     const std::uint32_t count_;
 };
 
+using block_ptr = std::shared_ptr<const block>;
+
 }
\ No newline at end of file
@@ -1,18 +1,57 @@
+#include <algorithm>
 #include <cassert>
 #include "sstable/block_builder.h"
 #include "sstable/format.h"
+#include "util/hash.h"
+#include "kv_format.h"
 
 using namespace cloudkv;
 
 block_builder::block_builder(const options& opts)
+    : block_builder(opts, opts.block_restart_interval)
+{
+}
+
+block_builder::block_builder(const options& opts, std::uint32_t restart_interval, sst::block_format format, bool key_heads)
+    : restart_interval_(std::max<std::uint32_t>(restart_interval, 1)),
+      format_(format),
+      key_heads_(key_heads && format != sst::block_format::flat)
 {
     buf_.reserve(opts.block_size);
+    reset();
+}
+
+void block_builder::reset()
+{
+    buf_.clear();
+    offset_.clear();
+    last_key_.clear();
+    first_key_.clear();
+    hashes_.clear();
+    count_ = 0;
+    counter_ = 0;
+
+    if (format_ != sst::block_format::flat) {
+        // first restart point
+        offset_.push_back(0);
+    }
 }
 
 void block_builder::add(std::string_view key, std::string_view value)
 {
     assert(!key.empty());
 
+    if (format_ == sst::block_format::flat) {
+        add_flat_(key, value);
+    } else {
+        add_prefix_(key, value);
+    }
+
+    ++count_;
+}
+
+void block_builder::add_flat_(std::string_view key, std::string_view value)
+{
     const auto offset = buf_.size();
 
     encode_str(&buf_, key);
@@ -21,13 +60,119 @@ void block_builder::add(std::string_view key, std::string_view value)
     offset_.push_back(offset);
 }
 
+void block_builder::add_prefix_(std::string_view key, std::string_view value)
+{
+    std::size_t shared = 0;
+    if (counter_ < restart_interval_) {
+        const auto limit = std::min(last_key_.size(), key.size());
+        while (shared < limit && last_key_[shared] == key[shared]) {
+            ++shared;
+        }
+    } else {
+        offset_.push_back(buf_.size());
+        counter_ = 0;
+    }
+
+    const auto unshared = key.size() - shared;
+
+    PutVarint32(&buf_, shared);
+    PutVarint32(&buf_, unshared);
+    PutVarint32(&buf_, value.size());
+    buf_.append(key.data() + shared, unshared);
+    buf_.append(value);
+
+    if (format_ == sst::block_format::prefix_hash) {
+        const auto user_key = extract_user_key(key);
+        hashes_.push_back(Hash(user_key.data(), user_key.size(), sst::block_hash_seed));
+    }
+
+    if (key_heads_ && count_ == 0) {
+        first_key_ = key;
+    }
+
+    last_key_.resize(shared);
+    last_key_.append(key.data() + shared, unshared);
+    ++counter_;
+}
+
 std::string_view block_builder::done()
 {
+    std::uint32_t flags = 0;
+    if (key_heads_) {
+        append_key_heads_();
+        flags = sst::block_key_heads_flag;
+    }
+
     for (const auto offset: offset_) {
         PutFixed32(&buf_, offset);
     }
 
-    PutFixed32(&buf_, offset_.size());
+    if (format_ == sst::block_format::flat) {
+        PutFixed32(&buf_, offset_.size());
+        return buf_;
+    }
+
+    auto format = sst::block_format::prefix;
+    if (format_ == sst::block_format::prefix_hash && offset_.size() <= max_hashed_restarts) {
+        append_hash_index_();
+        format = sst::block_format::prefix_hash;
+    }
+
+    PutFixed32(&buf_, count_);
+    PutFixed32(&buf_, ((static_cast<std::uint32_t>(format) | flags) << 24) | offset_.size());
 
     return buf_;
-}
\ No newline at end of file
+}
+
+void block_builder::append_hash_index_()
+{
+    assert(hashes_.size() == count_);
+
+    // load factor 0.75
+    const std::uint32_t bucket_count = count_ * 4 / 3 + 1;
+    std::string buckets(bucket_count, char(empty_bucket));
+
+    for (std::uint32_t i = 0; i < count_; ++i) {
+        const auto restart = static_cast<std::uint8_t>(i / restart_interval_);
+        auto& bucket = reinterpret_cast<std::uint8_t&>(buckets[hashes_[i] % bucket_count]);
+
+        if (bucket == empty_bucket) {
+            bucket = restart;
+        } else if (bucket != restart) {
+            bucket = collided_bucket;
+        }
+    }
+
+    buf_.append(buckets);
+    PutFixed32(&buf_, bucket_count);
+}
+
+void block_builder::append_key_heads_()
+{
+    // keys between the first and the last one share their common prefix
+    std::uint32_t skip = 0;
+    const auto limit = std::min(first_key_.size(), last_key_.size());
+    while (skip < limit && first_key_[skip] == last_key_[skip]) {
+        ++skip;
+    }
+
+    const auto entries_size = buf_.size();
+    PutFixed32(&buf_, skip);
+
+    for (const auto offset: offset_) {
+        char head[sst::block_key_head_size] = {};
+        if (offset < entries_size) {
+            std::uint32_t shared, unshared, value_length;
+            const char* p = buf_.data() + offset;
+            const char* end = buf_.data() + entries_size;
+            p = GetVarint32Ptr(p, end, &shared);
+            p = GetVarint32Ptr(p, end, &unshared);
+            p = GetVarint32Ptr(p, end, &value_length);
+            assert(p && shared == 0 && unshared >= skip);
+
+            std::copy_n(p + skip, std::min<std::uint32_t>(unshared - skip, sizeof(head)), head);
+        }
+
+        buf_.append(head, sizeof(head));
+    }
+}
@@ -5,17 +5,45 @@
 #include <string_view>
 #include <vector>
 #include "cloudkv/options.h"
+#include "sstable/format.h"
 
 namespace cloudkv {
 
 /**
+ * prefix format, the default:
+ *
+ * shared1 unshared1 value_len1 key_delta1 value1
+ * shared2 unshared2 value_len2 key_delta2 value2
+ * ...
+ * restart1
+ * ...
+ * restartM
+ * entry_count
+ * format << 24 | restart_count
+ *
+ * lengths are varint32, keys share no prefix at restart points, which are offsets of every restart_interval entries
+ *
+ * prefix_hash format, for blocks of internal keys, adds buckets between restarts and entry_count:
+ *
+ * bucket1 ... bucketK  uint8_t, restart of user keys hashed here, or empty_bucket/collided_bucket
+ * bucket_count         uint32_t
+ *
+ * blocks with more than max_hashed_restarts restarts fall back to the prefix format
+ *
+ * both prefix formats may add key heads between entries and restarts, flagged by block_key_heads_flag:
+ *
+ * head_skip            uint32_t, length of the prefix shared by all keys of the block
+ * head1 ... headM      8 bytes of restart keys following the shared prefix, zero padded, compared as big endian
+ *
+ * seeks binary search the contiguous heads and only decode restart keys on ties
+ *
+ * flat format, readable for blocks written before prefix compression:
+ *
  * key1 value1
  * key2 value2
  * ...
  * keyN valueN
  * offset1
- * offset2
- * offset3
  * ...
  * offsetN
  * offset_count
@@ -24,17 +52,18 @@ namespace cloudkv {
  */
 class block_builder {
 public:
+    enum : std::uint8_t { collided_bucket = 254, empty_bucket = 255 };
+    enum { max_hashed_restarts = collided_bucket };
+
     explicit block_builder(const options& opts);
 
+    block_builder(const options& opts, std::uint32_t restart_interval, sst::block_format format = sst::block_format::prefix, bool key_heads = false);
+
     void add(std::string_view key, std::string_view value);
 
     std::string_view done();
 
-    void reset()
-    {
-        buf_.clear();
-        offset_.clear();
-    }
+    void reset();
 
     std::uint64_t size_in_bytes() const
     {
@@ -42,8 +71,24 @@ public:
     }
 
 private:
+    void add_flat_(std::string_view key, std::string_view value);
+    void add_prefix_(std::string_view key, std::string_view value);
+    void append_hash_index_();
+    void append_key_heads_();
+
+private:
+    const std::uint32_t restart_interval_;
+    const sst::block_format format_;
+    const bool key_heads_;
+
     std::string buf_;
+    // every entry for flat blocks, restart points for prefix ones
     std::vector<std::uint32_t> offset_;
+    std::string last_key_;
+    std::string first_key_;  // for key heads
+    std::vector<std::uint32_t> hashes_;  // of user keys, for prefix_hash blocks
+    std::uint32_t count_ = 0;
+    std::uint32_t counter_ = 0;
 };
 
-}
\ No newline at end of file
+}
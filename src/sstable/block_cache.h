@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include "core.h"
+#include "sstable/block.h"
+#include "util/lru_cache.h"
+
+namespace cloudkv {
+
+/**
+ * @brief cache data blocks by (sstable id, block offset), charged by block size
+ *
+ * thread safe
+ */
+class block_cache : private noncopyable {
+public:
+    explicit block_cache(std::uint64_t capacity_in_bytes)
+        : cache_(capacity_in_bytes)
+    {
+    }
+
+    // return nullptr if not found
+    block_ptr find(std::uint64_t sst_id, std::uint64_t offset)
+    {
+        return cache_.find({ sst_id, offset });
+    }
+
+    void insert(std::uint64_t sst_id, std::uint64_t offset, block_ptr blk)
+    {
+        const auto charge = blk->size_in_bytes();
+        cache_.insert({ sst_id, offset }, std::move(blk), charge);
+    }
+
+    std::uint64_t bytes_used()
+    {
+        return cache_.total_charge();
+    }
+
+private:
+    struct cache_key {
+        std::uint64_t sst_id;
+        std::uint64_t offset;
+
+        bool operator==(const cache_key& other) const
+        {
+            return sst_id == other.sst_id && offset == other.offset;
+        }
+    };
+
+    struct cache_key_hash {
+        std::size_t operator()(const cache_key& key) const noexcept
+        {
+            // low bits of offsets are alike, mix all bits before sharding
+            std::uint64_t x = key.sst_id * 0x9e3779b97f4a7c15ULL + key.offset;
+            x ^= x >> 32;
+            x *= 0xd6e8feb86659fd93ULL;
+            x ^= x >> 32;
+
+            return x;
+        }
+    };
+
+    lru_cache<cache_key, block, cache_key_hash> cache_;
+};
+
+}
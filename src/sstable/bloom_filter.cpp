@@ -0,0 +1,84 @@
+#include <algorithm>
+#include "sstable/bloom_filter.h"
+#include "util/hash.h"
+
+using namespace cloudkv;
+
+namespace {
+
+constexpr std::uint32_t max_probe_count = 30;
+
+std::uint32_t bloom_hash(std::string_view key)
+{
+    return Hash(key.data(), key.size(), 0xbc9f1d34);
+}
+
+}
+
+bloom_filter_builder::bloom_filter_builder(std::uint32_t bits_per_key)
+    : bits_per_key_(bits_per_key)
+{
+}
+
+void bloom_filter_builder::add(std::string_view key)
+{
+    hashes_.push_back(bloom_hash(key));
+}
+
+std::string bloom_filter_builder::done()
+{
+    // k = ln2 * bits_per_key minimizes the false positive rate
+    const auto probe_count = std::clamp<std::uint32_t>(bits_per_key_ * 69 / 100, 1, max_probe_count);
+
+    // avoid high false positive rate for small sets
+    const std::uint64_t bits = std::max<std::uint64_t>(hashes_.size() * bits_per_key_, 64);
+    const std::uint64_t bytes = (bits + 7) / 8;
+    const std::uint64_t total_bits = bytes * 8;
+
+    std::string buf(bytes, 0);
+    for (auto h: hashes_) {
+        // double hashing, see [Kirsch, Mitzenmacher 2006]
+        const std::uint32_t delta = (h >> 17) | (h << 15);
+        for (std::uint32_t i = 0; i < probe_count; ++i) {
+            const auto pos = h % total_bits;
+            buf[pos / 8] |= (1 << (pos % 8));
+            h += delta;
+        }
+    }
+    buf.push_back(static_cast<char>(probe_count));
+
+    hashes_.clear();
+    return buf;
+}
+
+bloom_filter::bloom_filter(std::string content)
+    : buf_(std::move(content))
+{
+}
+
+bool bloom_filter::may_contain(std::string_view key) const
+{
+    if (buf_.size() < 2) {
+        return true;
+    }
+
+    const std::uint32_t probe_count = static_cast<std::uint8_t>(buf_.back());
+    if (probe_count > max_probe_count) {
+        // reserved for new encodings
+        return true;
+    }
+
+    const std::uint64_t total_bits = (buf_.size() - 1) * 8;
+
+    auto h = bloom_hash(key);
+    const std::uint32_t delta = (h >> 17) | (h << 15);
+    for (std::uint32_t i = 0; i < probe_count; ++i) {
+        const auto pos = h % total_bits;
+        if ((buf_[pos / 8] & (1 << (pos % 8))) == 0) {
+            return false;
+        }
+        h += delta;
+    }
+
+    return true;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cloudkv {
+
+/**
+ * bit1 bit2 ... bitN
+ * probe_count  uint8_t
+ *
+ * basic guarantee
+ */
+class bloom_filter_builder {
+public:
+    explicit bloom_filter_builder(std::uint32_t bits_per_key);
+
+    void add(std::string_view key);
+
+    std::string done();
+
+    bool empty() const
+    {
+        return hashes_.empty();
+    }
+
+private:
+    const std::uint32_t bits_per_key_;
+    std::vector<std::uint32_t> hashes_;
+};
+
+class bloom_filter {
+public:
+    // an empty filter matches everything
+    explicit bloom_filter(std::string content = {});
+
+    bool may_contain(std::string_view key) const;
+
+    std::uint64_t size_in_bytes() const
+    {
+        return buf_.size();
+    }
+
+private:
+    std::string buf_;
+};
+
+}
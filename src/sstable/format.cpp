@@ -1,7 +1,10 @@
 #include <cassert>
 #include "cloudkv/exception.h"
 #include "sstable/format.h"
+#include "util/compression.h"
+#include "util/crc32c.h"
 #include "util/fmt_std.h"
+#include "util/random_access_file.h"
 
 using namespace cloudkv;
 using namespace cloudkv::sst;
@@ -22,8 +25,61 @@ void block_handle::encode_to(std::string* out)
     PutFixed64(out, length_);
 }
 
+void sst::encode_block_trailer(std::string_view content, compression_type ctype, std::string* out)
+{
+    const char type = static_cast<char>(ctype);
+    const auto crc = crc32c::extend(crc32c::value(content), &type, 1);
+
+    out->push_back(type);
+    PutFixed32(out, crc32c::mask(crc));
+}
+
+std::string_view sst::read_block_content(const random_access_file& file, block_handle handle, bool has_trailer, bool verify, std::string* scratch)
+{
+    const auto size = block_read_size(handle, has_trailer);
+    if (file.size() < handle.offset() + size) {
+        throw data_corrupted{ fmt::format("block handle {}+{} out of file {}", handle.offset(), handle.length(), file.path()) };
+    }
+
+    return decode_block_content(file, file.read(handle.offset(), size, scratch), handle, has_trailer, verify, scratch);
+}
+
+std::string_view sst::decode_block_content(const random_access_file& file, std::string_view content, block_handle handle, bool has_trailer, bool verify, std::string* scratch)
+{
+    assert(content.size() == block_read_size(handle, has_trailer));
+    if (!has_trailer) {
+        return content;
+    }
+
+    const auto trailer = content.substr(handle.length());
+    content.remove_suffix(block_trailer_size);
+
+    if (verify) {
+        const auto expected = crc32c::unmask(DecodeFixed32(trailer.data() + 1));
+        const auto actual = crc32c::extend(crc32c::value(content), trailer.data(), 1);
+        if (actual != expected) {
+            throw data_corrupted{ fmt::format("block checksum mismatch at {} in {}", handle.offset(), file.path()) };
+        }
+    }
+
+    const auto type = static_cast<compression_type>(trailer[0]);
+    if (type == compression_type::none) {
+        return content;
+    }
+
+    std::string raw;
+    try {
+        uncompress(type, content, &raw);
+    } catch (data_corrupted& e) {
+        throw data_corrupted{ fmt::format("{}, at {} in {}", e.what(), handle.offset(), file.path()) };
+    }
+
+    swap(raw, *scratch);
+    return *scratch;
+}
+
 footer::footer(std::string_view buf)
-    : data_index_(-1, -1), meta_index_(-1, -1)
+    : data_index_(-1, -1), meta_index_(-1, -1), has_block_trailer_(true)
 {
     assert(buf.size() == footer_size);
 
@@ -35,7 +91,9 @@ footer::footer(std::string_view buf)
 
     const auto magic = DecodeFixed64(buf.data());
     buf.remove_prefix(sizeof(magic));
-    if (magic != table_magic) {
+    if (magic == table_magic_legacy) {
+        has_block_trailer_ = false;
+    } else if (magic != table_magic) {
         throw data_corrupted{ fmt::format("footer corrupted, magic={}, expect={}", magic, table_magic) };
     }
 }
@@ -4,15 +4,36 @@
 #include <string>
 #include <string_view>
 #include <stdexcept>
+#include "cloudkv/options.h"
 #include "util/format.h"
 
 namespace cloudkv {
 
+class random_access_file;
+
 namespace sst {
 
 inline constexpr std::string_view metablock_first_key = "first_key";
 inline constexpr std::string_view metablock_last_key = "last_key";
 inline constexpr std::string_view metablock_entry_count = "entry_count";
+inline constexpr std::string_view metablock_filter = "filter";
+inline constexpr std::string_view metablock_index_partitioned = "index_partitioned";
+inline constexpr std::string_view metablock_index_model = "index_model";
+inline constexpr std::string_view metablock_blob_files = "blob_files";  // ids of blob files referred to, fixed64 each
+
+// kept in the high byte of the last fixed32 of a block
+// flat blocks predate the others and end with their entry count, whose high byte is always 0
+enum class block_format : std::uint8_t {
+    flat = 0,           // every entry stored in full, with an offset per entry
+    prefix = 1,         // keys prefix compressed against the previous one, with restart points
+    prefix_hash = 2,    // prefix, plus a hash index from user keys of internal keys to restart points
+};
+
+inline constexpr std::uint32_t block_hash_seed = 0x9ae16a3b;
+
+// or-ed into the format byte of prefix blocks carrying key heads of restart points
+inline constexpr std::uint32_t block_key_heads_flag = 0x80;
+inline constexpr std::uint32_t block_key_head_size = 8;
 
 class block_handle {
 public:
@@ -42,6 +63,32 @@ private:
     std::uint64_t length_ = -1;
 };
 
+/**
+ * every block is followed by a trailer, which handles exclude:
+ *
+ * type     uint8_t, compression_type of the block
+ * crc      uint32_t, masked crc32c of block content and type
+ *
+ * compressed blocks start with their raw length in varint32
+ * sstables written with the legacy magic have no trailers
+ */
+inline constexpr std::uint64_t block_trailer_size = 1 + sizeof(std::uint32_t);
+
+void encode_block_trailer(std::string_view content, compression_type type, std::string* out);
+
+// read the block at handle, trailer stripped, crc checked if verify is set, and uncompressed
+// the result is either in the mapped file, or at the beginning of scratch
+std::string_view read_block_content(const random_access_file& file, block_handle handle, bool has_trailer, bool verify, std::string* scratch);
+
+// bytes to read for the block at handle
+inline std::uint64_t block_read_size(block_handle handle, bool has_trailer)
+{
+    return handle.length() + (has_trailer? block_trailer_size: 0);
+}
+
+// same as read_block_content, on the block_read_size bytes already read into raw
+std::string_view decode_block_content(const random_access_file& file, std::string_view raw, block_handle handle, bool has_trailer, bool verify, std::string* scratch);
+
 /**
  * dataindex block_handle
  * metaindex block_handle
@@ -49,11 +96,12 @@ private:
  */
 class footer {
 public:
-    enum { table_magic = 2021122501LL };
+    enum { table_magic = 2026101801LL };
+    enum { table_magic_legacy = 2021122501LL };  // blocks without trailers
     enum { footer_size = 2 * block_handle::block_handle_size + sizeof(std::uint64_t) };
 
     footer(block_handle dataindex, block_handle metaindex)
-        : data_index_(dataindex), meta_index_(metaindex)
+        : data_index_(dataindex), meta_index_(metaindex), has_block_trailer_(true)
     {
     }
 
@@ -69,11 +117,18 @@ public:
         return meta_index_;
     }
 
+    // false for sstables written before checksums
+    bool has_block_trailer() const
+    {
+        return has_block_trailer_;
+    }
+
     void encode_to(std::string* out);
 
 private:
     block_handle data_index_;
     block_handle meta_index_;
+    bool has_block_trailer_;
 };
 
 }
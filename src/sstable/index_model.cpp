@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <fmt/core.h>
+#include "cloudkv/exception.h"
+#include "sstable/index_model.h"
+#include "util/coding.h"
+
+using namespace cloudkv;
+
+namespace {
+
+constexpr std::size_t header_size = 3 * sizeof(std::uint32_t) + 1;
+constexpr std::size_t segment_size = 2 * sizeof(std::uint64_t) + sizeof(std::uint32_t);
+
+// models much larger than this fraction of the index save nothing over binary search
+constexpr std::uint32_t min_keys_per_segment = 8;
+
+// digits fitting in uint64_t
+constexpr std::size_t max_decimal_digits = 19;
+
+bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// monotonic for keys of the same radix, shorter keys are padded with zeros
+std::uint64_t key_number(std::string_view key, std::uint32_t skip, std::uint32_t radix)
+{
+    key.remove_prefix(std::min<std::size_t>(skip, key.size()));
+
+    std::uint64_t x = 0;
+    if (radix == 10) {
+        for (std::size_t i = 0; i < max_decimal_digits; ++i) {
+            const auto digit = i < key.size() && is_digit(key[i]) ? key[i] - '0' : 0;
+            x = x * 10 + digit;
+        }
+    } else {
+        for (std::size_t i = 0; i < sizeof(x); ++i) {
+            x = (x << 8) | (i < key.size() ? static_cast<std::uint8_t>(key[i]) : 0);
+        }
+    }
+
+    return x;
+}
+
+double predict_position(const std::vector<index_segment>& segments, std::uint64_t x)
+{
+    auto it = std::upper_bound(segments.begin(), segments.end(), x, [](std::uint64_t x, const index_segment& s) {
+        return x < s.x0;
+    });
+    if (it == segments.begin()) {
+        return 0;
+    }
+
+    --it;
+    return it->y0 + it->slope * double(x - it->x0);
+}
+
+std::uint64_t double_bits(double d)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    return bits;
+}
+
+double bits_double(std::uint64_t bits)
+{
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+}
+
+index_model_builder::index_model_builder(std::uint32_t max_error)
+    : max_error_(max_error)
+{
+}
+
+void index_model_builder::add(std::string_view user_key)
+{
+    keys_.emplace_back(user_key);
+}
+
+std::string index_model_builder::done()
+{
+    const auto keys = std::move(keys_);
+    keys_.clear();
+
+    const std::uint32_t n = keys.size();
+    if (n < min_keys_per_segment) {
+        return {};
+    }
+
+    std::uint32_t skip = 0;
+    const auto& first = keys.front();
+    const auto& last = keys.back();
+    while (skip < first.size() && skip < last.size() && first[skip] == last[skip]) {
+        ++skip;
+    }
+
+    const bool decimal = std::all_of(keys.begin(), keys.end(), [skip](const std::string& k) {
+        return k.size() >= skip && k.size() - skip <= max_decimal_digits &&
+            std::all_of(k.begin() + skip, k.end(), is_digit);
+    });
+    const std::uint32_t radix = decimal ? 10 : 256;
+
+    std::vector<std::uint64_t> xs;
+    xs.reserve(n);
+    for (const auto& k: keys) {
+        xs.push_back(key_number(k, skip, radix));
+    }
+
+    // shrinking cone: extend a segment while some slope keeps all its points within max_error
+    std::vector<index_segment> segments;
+    for (std::uint32_t i = 0; i < n;) {
+        double lo = 0;
+        double hi = std::numeric_limits<double>::infinity();
+
+        std::uint32_t j = i + 1;
+        for (; j < n; ++j) {
+            const double dy = j - i;
+            if (xs[j] == xs[i]) {
+                if (dy > max_error_) {
+                    break;
+                }
+                continue;
+            }
+
+            const double dx = double(xs[j] - xs[i]);
+            const auto new_lo = std::max(lo, (dy - max_error_) / dx);
+            const auto new_hi = std::min(hi, (dy + max_error_) / dx);
+            if (new_lo > new_hi) {
+                break;
+            }
+
+            lo = new_lo;
+            hi = new_hi;
+        }
+
+        segments.push_back({ xs[i], std::isinf(hi) ? lo : (lo + hi) / 2, i });
+        i = j;
+    }
+
+    if (segments.size() * min_keys_per_segment > n) {
+        return {};
+    }
+
+    // measured rather than trusted, positions are rounded on lookups
+    double error = 0;
+    for (std::uint32_t i = 0; i < n; ++i) {
+        error = std::max(error, std::abs(predict_position(segments, xs[i]) - i));
+    }
+
+    std::string buf;
+    buf.reserve(header_size + segments.size() * segment_size);
+    PutFixed32(&buf, skip);
+    buf.push_back(static_cast<char>(radix == 10 ? 10 : 0));
+    PutFixed32(&buf, static_cast<std::uint32_t>(std::ceil(error)) + 1);
+    PutFixed32(&buf, n);
+    for (const auto& s: segments) {
+        PutFixed64(&buf, s.x0);
+        PutFixed64(&buf, double_bits(s.slope));
+        PutFixed32(&buf, s.y0);
+    }
+
+    return buf;
+}
+
+index_model::index_model(std::string_view content)
+{
+    if (content.empty()) {
+        return;
+    }
+    if (content.size() < header_size || (content.size() - header_size) % segment_size != 0) {
+        throw data_corrupted{ fmt::format("invalid index model of size {}", content.size()) };
+    }
+
+    const char* p = content.data();
+    skip_ = DecodeFixed32(p);
+    radix_ = p[4] == 10 ? 10 : 256;
+    max_error_ = DecodeFixed32(p + 5);
+    entry_count_ = DecodeFixed32(p + 9);
+    p += header_size;
+
+    const auto segment_count = (content.size() - header_size) / segment_size;
+    segments_.reserve(segment_count);
+    for (std::size_t i = 0; i < segment_count; ++i, p += segment_size) {
+        const index_segment s{ DecodeFixed64(p), bits_double(DecodeFixed64(p + 8)), DecodeFixed32(p + 16) };
+        if (s.y0 >= entry_count_ || !std::isfinite(s.slope) || (!segments_.empty() && s.x0 < segments_.back().x0)) {
+            throw data_corrupted{ fmt::format("invalid segment {} of index model", i) };
+        }
+
+        segments_.push_back(s);
+    }
+}
+
+std::optional<index_window> index_model::predict(std::string_view user_key) const
+{
+    if (segments_.empty()) {
+        return std::nullopt;
+    }
+
+    const auto pos = predict_position(segments_, key_number(user_key, skip_, radix_));
+    const auto p = static_cast<std::int64_t>(std::llround(std::clamp(pos, 0.0, double(entry_count_))));
+
+    return index_window{
+        static_cast<std::uint32_t>(std::max<std::int64_t>(p - max_error_, 0)),
+        static_cast<std::uint32_t>(std::min<std::int64_t>(p + max_error_ + 1, entry_count_)),
+    };
+}
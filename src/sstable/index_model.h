@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cloudkv {
+
+// entries [first, last) of the data index expected to hold the lower bound of a key
+struct index_window {
+    std::uint32_t first;
+    std::uint32_t last;
+};
+
+struct index_segment {
+    std::uint64_t x0;  // first key mapped
+    double slope;
+    std::uint32_t y0;  // position of the first key
+};
+
+/**
+ * piecewise linear model from user keys to positions in the data index, as PGM indexes do
+ *
+ * keys are mapped to integers by the bytes following the prefix shared by all keys,
+ * read as decimal digits if all keys are, or as a big endian integer otherwise
+ *
+ * skip         uint32_t
+ * radix        uint8_t, 10 or 0 for 256
+ * max_error    uint32_t
+ * entry_count  uint32_t
+ * segment1 ... segmentN  x0 uint64_t, slope double as uint64_t, y0 uint32_t
+ *
+ * basic guarantee
+ */
+class index_model_builder {
+public:
+    // segments keep positions of keys added within max_error
+    explicit index_model_builder(std::uint32_t max_error);
+
+    // user keys in order, one per data index entry
+    void add(std::string_view user_key);
+
+    // empty if keys are too far from linear to be worth a model
+    std::string done();
+
+    bool empty() const
+    {
+        return keys_.empty();
+    }
+
+private:
+    const std::uint32_t max_error_;
+    std::vector<std::string> keys_;
+};
+
+class index_model {
+public:
+    // an empty model predicts nothing
+    explicit index_model(std::string_view content = {});
+
+    // nullopt if there is no model, the window may still miss keys absent from the index
+    std::optional<index_window> predict(std::string_view user_key) const;
+
+    std::uint32_t segment_count() const
+    {
+        return segments_.size();
+    }
+
+    std::uint32_t max_error() const
+    {
+        return max_error_;
+    }
+
+private:
+    std::uint32_t skip_ = 0;
+    std::uint32_t radix_ = 0;
+    std::uint32_t max_error_ = 0;
+    std::uint32_t entry_count_ = 0;
+    std::vector<index_segment> segments_;
+};
+
+}
@@ -1,6 +1,7 @@
+#include <atomic>
 #include <string_view>
-#include <fstream>
 #include <filesystem>
+#include <map>
 #include <optional>
 #include <fmt/core.h>
 #include <range/v3/algorithm.hpp>
@@ -8,8 +9,9 @@
 #include "sstable/format.h"
 #include "sstable/sstable.h"
 #include "sstable/block.h"
+#include "sstable/table_cache.h"
 #include "util/fmt_std.h"
-#include "util/exception_util.h"
+#include "kv_format.h"
 
 using namespace std;
 using namespace cloudkv;
@@ -17,54 +19,61 @@ using namespace cloudkv::sst;
 
 namespace fs = filesystem;
 
+namespace {
+
+std::atomic_uint64_t next_sstable_id { 1 };
+
+}
+
 class sstable::sstable_iter : public kv_iter {
 public:
-    explicit sstable_iter(const path_t& path, block_handle dataindex);
+    // blocks entirely out of [lower, upper) are not read, keys out of it in the blocks read are still returned
+    sstable_iter(table_reader_ptr reader, bool verify_checksums, std::uint64_t readahead_size,
+                 std::string_view lower = {}, std::string_view upper = {});
 
     void seek_first() override;
     void seek(std::string_view key) override;
 
+    void seek_last() override;
+    void seek_for_prev(std::string_view key) override;
+
     bool is_eof() override;
 
     void next() override;
+    void prev() override;
 
     key_value_pair current() override;
 
 private:
     void load_block_();
 
+    // move to the last entry of previous blocks while the current one is exhausted
+    void skip_exhausted_blocks_backward_();
+
 private:
-    std::ifstream in_;
-    std::string buf_;
+    const table_reader_ptr reader_;
+    const bool verify_checksums_;
+    const std::string lower_;
+    const std::string upper_;
 
-    std::unique_ptr<block> index_block_;
     iter_ptr index_iter_;
+    std::optional<readahead_buffer> readahead_;
 
-    std::unique_ptr<block> current_data_block_;
+    block_ptr current_data_block_;
     iter_ptr current_data_iter_;
 };
 
-sstable::sstable_iter::sstable_iter(const path_t& path, sst::block_handle dataindex)
-    : in_(path, std::ios::binary)
+sstable::sstable_iter::sstable_iter(table_reader_ptr reader, bool verify_checksums, std::uint64_t readahead_size,
+                                    std::string_view lower, std::string_view upper)
+    : reader_(std::move(reader)),
+      verify_checksums_(verify_checksums),
+      lower_(lower),
+      upper_(upper),
+      index_iter_(reader_->index_iter())
 {
-    if (!in_) {
-        throw db_corrupted{ fmt::format("open sst {} failed", path) };
+    if (readahead_size > 0) {
+        readahead_.emplace(readahead_size);
     }
-
-    in_.exceptions(std::ios::failbit | std::ios::badbit);
-
-    const std::uint64_t file_size = fs::file_size(path);
-    if (file_size < dataindex.offset() + dataindex.length()) {
-        throw data_corrupted{ fmt::format("invalid data index handle in sstable {}", path) };
-    }
-
-    std::string buf;
-    buf.resize(dataindex.length());
-
-    in_.seekg(dataindex.offset());
-    in_.read(buf.data(), buf.size());
-    index_block_ = std::make_unique<block>(buf);
-    index_iter_ = index_block_->iter();
 }
 
 void sstable::sstable_iter::load_block_()
@@ -75,18 +84,15 @@ void sstable::sstable_iter::load_block_()
     auto content = index_iter_->current().value;
     sst::block_handle handle(content);
 
-    buf_.resize(handle.length());
-
-    in_.seekg(handle.offset());
-    in_.read(buf_.data(), buf_.size());
-
     // fixme: empty block?
-    current_data_block_ = std::make_unique<block>(buf_);
+    current_data_block_ = reader_->read_block(handle, verify_checksums_, readahead_? &*readahead_: nullptr);
     current_data_iter_ = current_data_block_->iter();
 }
 
 void sstable::sstable_iter::seek_first()
 {
+    current_data_iter_.reset();
+
     index_iter_->seek_first();
     if (index_iter_->is_eof()) {
         return;
@@ -100,6 +106,11 @@ void sstable::sstable_iter::seek_first()
 
 void sstable::sstable_iter::seek(std::string_view key)
 {
+    current_data_iter_.reset();
+    if (!upper_.empty() && key >= upper_) {
+        return;
+    }
+
     index_iter_->seek(key);
     if (index_iter_->is_eof()) {
         return;
@@ -124,6 +135,11 @@ void sstable::sstable_iter::next()
     if (current_data_iter_->is_eof()) {
         current_data_iter_.reset();
 
+        // index keys are the last keys of blocks, so the following blocks are past the bound
+        if (!upper_.empty() && extract_user_key(index_iter_->current().key) >= upper_) {
+            return;
+        }
+
         index_iter_->next();
         if (!index_iter_->is_eof()) {
             load_block_();
@@ -132,6 +148,65 @@ void sstable::sstable_iter::next()
     }
 }
 
+void sstable::sstable_iter::seek_last()
+{
+    current_data_iter_.reset();
+
+    index_iter_->seek_last();
+    if (index_iter_->is_eof()) {
+        return;
+    }
+
+    load_block_();
+    current_data_iter_->seek_last();
+    skip_exhausted_blocks_backward_();
+}
+
+void sstable::sstable_iter::seek_for_prev(std::string_view key)
+{
+    current_data_iter_.reset();
+    if (!lower_.empty() && key < lower_) {
+        return;
+    }
+
+    // the first block whose last key is not less than key, keys before it may be in the previous block
+    index_iter_->seek(key);
+    if (index_iter_->is_eof()) {
+        seek_last();
+        return;
+    }
+
+    load_block_();
+    current_data_iter_->seek_for_prev(key);
+    skip_exhausted_blocks_backward_();
+}
+
+void sstable::sstable_iter::prev()
+{
+    assert(!is_eof());
+    assert(current_data_iter_);
+
+    current_data_iter_->prev();
+    skip_exhausted_blocks_backward_();
+}
+
+void sstable::sstable_iter::skip_exhausted_blocks_backward_()
+{
+    while (current_data_iter_ && current_data_iter_->is_eof()) {
+        current_data_iter_.reset();
+
+        index_iter_->prev();
+        if (!index_iter_->is_eof()) {
+            if (!lower_.empty() && extract_user_key(index_iter_->current().key) < lower_) {
+                return;
+            }
+
+            load_block_();
+            current_data_iter_->seek_last();
+        }
+    }
+}
+
 kv_iter::key_value_pair sstable::sstable_iter::current()
 {
     assert(!is_eof());
@@ -139,44 +214,36 @@ kv_iter::key_value_pair sstable::sstable_iter::current()
 }
 
 sstable::sstable(const path_t& file)
-    : path_(file)
+    : id_(next_sstable_id.fetch_add(1, std::memory_order_relaxed)),
+      path_(file)
 {
-    std::ifstream ifs(file, std::ios::binary);
-    if (!ifs) {
-        throw_system_error(fmt::format("open sst {} failed", file));
-    }
-
-    ifs.exceptions(std::ios::failbit | std::ios::badbit);
+    const random_access_file in(file);
 
-    const int64_t fsize = fs::file_size(file);
+    const std::uint64_t fsize = in.size();
     if (fsize < footer::footer_size) {
         throw data_corrupted{ fmt::format("sst {} too small for a footer", file) };
     }
 
     std::string buf;
-    buf.resize(footer::footer_size);
-    ifs.seekg(fsize - footer::footer_size);
-    ifs.read(buf.data(), buf.size());
-
-    footer f(buf);
+    footer f(in.read(fsize - footer::footer_size, footer::footer_size, &buf));
     dataindex_ = f.data_index();
-    load_meta_(ifs, f.meta_index());
+    has_block_trailer_ = f.has_block_trailer();
+    load_meta_(in, f.meta_index());
 
     size_in_bytes_ = fsize - footer::footer_size;
 }
 
-void sstable::load_meta_(std::istream& in, sst::block_handle metahandle)
+void sstable::load_meta_(const random_access_file& in, sst::block_handle metahandle)
 {
     std::string buf;
+    read_block_content(in, metahandle, has_block_trailer_, true, &buf);
     buf.resize(metahandle.length());
 
-    in.seekg(metahandle.offset());
-    in.read(buf.data(), buf.size());
-
-    block blk(buf);
+    block blk(std::move(buf));
 
     auto it = blk.iter();
     bool count_seen = false;
+    std::optional<block_handle> filter_handle;
     for (it->seek_first(); !it->is_eof(); it->next()) {
         const auto [k, v] = it->current();
 
@@ -191,6 +258,20 @@ void sstable::load_meta_(std::istream& in, sst::block_handle metahandle)
 
             count_seen = true;
             count_ = DecodeFixed64(v.data());
+        } else if (k == sst::metablock_filter) {
+            filter_handle.emplace(v);
+        } else if (k == sst::metablock_index_partitioned) {
+            index_partitioned_ = true;
+        } else if (k == sst::metablock_index_model) {
+            index_model_ = index_model(v);
+        } else if (k == sst::metablock_blob_files) {
+            if (v.size() % sizeof(std::uint64_t) != 0) {
+                throw data_corrupted{ fmt::format("invalid blob_files in metablock") };
+            }
+
+            for (std::size_t i = 0; i < v.size(); i += sizeof(std::uint64_t)) {
+                blob_files_.push_back(DecodeFixed64(v.data() + i));
+            }
         }
     }
 
@@ -200,9 +281,90 @@ void sstable::load_meta_(std::istream& in, sst::block_handle metahandle)
     if (key_min_.empty() || key_max_.empty()) {
         throw data_corrupted{ fmt::format("invalid first_key or last_key in metablock") };
     }
+
+    if (filter_handle) {
+        std::string filter;
+        read_block_content(in, *filter_handle, has_block_trailer_, true, &filter);
+        filter.resize(filter_handle->length());
+
+        filter_ = bloom_filter(std::move(filter));
+    }
+}
+
+iter_ptr sstable::iter(std::uint64_t readahead_size)
+{
+    // uncached readers are for full scans, eg. compactions, whose outputs must never carry corruptions
+    return std::make_unique<sstable_iter>(make_reader({ nullptr, false, access_hint::sequential }), true, readahead_size);
+}
+
+iter_ptr sstable::iter(table_cache& cache, const read_options& opts)
+{
+    return std::make_unique<sstable_iter>(cache.get(*this), opts.verify_checksums, opts.readahead_size, opts.lower_bound, opts.upper_bound);
+}
+
+std::optional<lookup_result> sstable::get(table_cache& cache, std::string_view user_key, const read_options& opts, std::string* scratch)
+{
+    return cache.get(*this)->get(user_key, opts.verify_checksums, scratch, index_model_.predict(user_key));
+}
+
+void sstable::multi_get(table_cache& cache, std::vector<sstable_get>& lookups, const read_options& opts)
+{
+    std::vector<table_reader_ptr> readers;
+    std::vector<get_context> contexts(lookups.size());
+    std::vector<read_request> reads;
+    std::vector<get_context*> reading;
+
+    // lookups falling in a block already being read share the read, by the first lookup of the block
+    std::map<std::pair<std::uint64_t, std::uint64_t>, std::size_t> first_reader;
+    std::vector<std::optional<std::size_t>> shared_read(lookups.size());
+
+    readers.reserve(lookups.size());
+    for (std::size_t i = 0; i < lookups.size(); ++i) {
+        auto& lookup = lookups[i];
+        auto& ctx = contexts[i];
+
+        ctx.user_key = lookup.user_key;
+        ctx.verify_checksums = opts.verify_checksums;
+        ctx.scratch = &lookup.scratch;
+        ctx.predicted = lookup.sst->index_model_.predict(lookup.user_key);
+
+        readers.push_back(cache.get(*lookup.sst));
+        if (!readers.back()->start_get(ctx)) {
+            continue;
+        }
+
+        const auto [it, first] = first_reader.try_emplace({ lookup.sst->id(), ctx.read.offset }, i);
+        if (!first) {
+            shared_read[i] = it->second;
+            ctx.read = {};
+            continue;
+        }
+
+        reads.push_back(ctx.read);
+        reading.push_back(&ctx);
+    }
+
+    if (cache.io() && reads.size() > 1) {
+        cache.io()->read(reads);
+    } else {
+        for (auto& r: reads) {
+            r.result = r.file->read(r.offset, r.length, r.buf);
+        }
+    }
+    for (std::size_t i = 0; i < reads.size(); ++i) {
+        reading[i]->read.result = reads[i].result;
+    }
+
+    // blocks are decoded by the first lookup, which always comes before those sharing it
+    for (std::size_t i = 0; i < lookups.size(); ++i) {
+        if (shared_read[i]) {
+            contexts[i].block = contexts[*shared_read[i]].block;
+        }
+        lookups[i].result = readers[i]->finish_get(contexts[i]);
+    }
 }
 
-iter_ptr sstable::iter()
+table_reader_ptr sstable::make_reader(const table_reader_options& opts) const
 {
-    return std::make_unique<sstable_iter>(path_, dataindex_);
+    return std::make_shared<table_reader>(path_, id_, dataindex_, has_block_trailer_, index_partitioned_, opts);
 }
@@ -3,18 +3,54 @@
 #include <cstdint>
 #include <vector>
 #include <memory>
-#include <istream>
+#include <optional>
 #include "core.h"
 #include "cloudkv/iter.h"
+#include "cloudkv/options.h"
 #include "sstable/format.h"
+#include "sstable/table_reader.h"
+#include "sstable/bloom_filter.h"
+#include "sstable/index_model.h"
 
 namespace cloudkv {
 
+class table_cache;
+class sstable;
+
+// a lookup of sstable::multi_get, the result may point to scratch
+struct sstable_get {
+    sstable* sst = nullptr;
+    std::string_view user_key;
+
+    std::optional<lookup_result> result;
+    std::string scratch;
+};
+
 class sstable {
 public:
     explicit sstable(const path_t& file);
 
-    iter_ptr iter();
+    // full scan by a reader of its own, reading ahead at most readahead_size bytes once reads turn sequential
+    iter_ptr iter(std::uint64_t readahead_size = 0);
+
+    // reuse the opened file and data index kept in cache, blocks out of the bounds of opts are not read
+    iter_ptr iter(table_cache& cache, const read_options& opts = {});
+
+    // point lookup by user key, return nullopt if not found
+    // scratch can be shared by lookups, the result keeps valid until the next one
+    std::optional<lookup_result> get(table_cache& cache, std::string_view user_key, const read_options& opts, std::string* scratch);
+
+    // point lookups of several sstables or keys, data blocks missing in cache are read at once by io of cache
+    // and only once for all lookups falling in them
+    static void multi_get(table_cache& cache, std::vector<sstable_get>& lookups, const read_options& opts);
+
+    table_reader_ptr make_reader(const table_reader_options& opts = {}) const;
+
+    // unique in process, used as cache key
+    std::uint64_t id() const
+    {
+        return id_;
+    }
 
     std::string_view min() const
     {
@@ -26,6 +62,12 @@ public:
         return key_max_;
     }
 
+    // false if the user key is definitely not in this sstable
+    bool may_contain(std::string_view user_key) const
+    {
+        return filter_.may_contain(user_key);
+    }
+
     std::uint64_t count() const
     {
         return count_;
@@ -36,25 +78,43 @@ public:
         return size_in_bytes_;
     }
 
+    // kept in memory as long as the sstable lives, along with the index model
+    std::uint64_t filter_size_in_bytes() const
+    {
+        return filter_.size_in_bytes();
+    }
+
+    // ids of blob files its blob_index entries refer to, sorted
+    const std::vector<std::uint64_t>& blob_files() const
+    {
+        return blob_files_;
+    }
+
     const path_t& path() const
     {
         return path_;
     }
 
 private:
-    void load_meta_(std::istream& in, sst::block_handle metahandle);
+    void load_meta_(const random_access_file& in, sst::block_handle metahandle);
 
 private:
     class sstable_iter;
 
 private:
+    const std::uint64_t id_;
     path_t path_;
 
     sst::block_handle dataindex_;
+    bool has_block_trailer_ = true;
+    bool index_partitioned_ = false;
     std::string key_min_;
     std::string key_max_;
     std::uint64_t count_ = 0;
     std::uint64_t size_in_bytes_ = 0;
+    bloom_filter filter_;
+    index_model index_model_;
+    std::vector<std::uint64_t> blob_files_;
 };
 
 using sstable_ptr = std::shared_ptr<sstable>;
@@ -2,19 +2,38 @@
 #include <cstdint>
 #include <fmt/core.h>
 #include "util/coding.h"
+#include "util/compression.h"
+#include "util/direct_filebuf.h"
 #include "util/fmt_std.h"
 #include "util/exception_util.h"
 #include "sstable/format.h"
 #include "sstable/sstable_builder.h"
+#include "blob/blob_file.h"
+#include "kv_format.h"
 
 using namespace std;
 using namespace cloudkv;
 
+namespace {
+
+// entries of the data index searched around predictions
+constexpr std::uint32_t index_model_max_error = 4;
+
+sst::block_format data_block_format(const options& opts)
+{
+    return opts.data_block_hash_index ? sst::block_format::prefix_hash : sst::block_format::prefix;
+}
+
+}
+
 sstable_builder::sstable_builder(const options& opts, std::ostream& out)
     : options_(opts),
       out_(out),
-      datablock_(options_),
-      datablock_index_(options_)
+      datablock_(options_, options_.block_restart_interval, data_block_format(options_), options_.block_key_heads),
+      datablock_index_(options_, 1, sst::block_format::prefix, options_.block_key_heads),
+      top_index_(options_, 1, sst::block_format::prefix, options_.block_key_heads),
+      filter_(options_.bloom_bits_per_key),
+      model_(index_model_max_error)
 {
     if (!out_) {
         throw_system_error(fmt::format("create sst failed"));
@@ -26,10 +45,14 @@ sstable_builder::sstable_builder(const options& opts, std::ostream& out)
 sstable_builder::sstable_builder(const options& opts, const path_t& p)
     : options_(opts),
       path_(p),
-      buf_(std::make_unique<std::ofstream>(p, std::ios::binary)),
+      filebuf_(open_output_file(p, opts.use_direct_io)),
+      buf_(std::make_unique<std::ostream>(filebuf_.get())),
       out_(*buf_.get()),
-      datablock_(options_),
-      datablock_index_(options_)
+      datablock_(options_, options_.block_restart_interval, data_block_format(options_), options_.block_key_heads),
+      datablock_index_(options_, 1, sst::block_format::prefix, options_.block_key_heads),
+      top_index_(options_, 1, sst::block_format::prefix, options_.block_key_heads),
+      filter_(options_.bloom_bits_per_key),
+      model_(index_model_max_error)
 {
     if (!out_) {
         throw_system_error(fmt::format("create sst {} failed", path_));
@@ -45,12 +68,19 @@ void sstable_builder::add(std::string_view key, std::string_view value)
     assert(last_key_.empty() || last_key_ < key);
 
     datablock_.add(key, value);
+    if (options_.bloom_bits_per_key > 0) {
+        // lookups by user key need no tag
+        filter_.add(extract_user_key(key));
+    }
     if (first_key_.empty()) {
         first_key_ = key;
     }
     last_key_ = key;
-    size_in_bytes_ += key.size() + value.size() + 2 * sizeof(std::uint32_t);  // uint32_t for str length
     ++entry_count_;
+    // keys are assumed well-formed; the tag byte is trusted here as in extract_user_key
+    if (key.size() > 1 && key.back() == static_cast<char>(key_type::blob_index)) {
+        blob_files_.insert(blob_ref::decode(value).file_id);
+    }
 
     if (datablock_.size_in_bytes() >= options_.block_size) {
         commit_datablock_();
@@ -66,20 +96,24 @@ void sstable_builder::done()
     out_.flush();
 }
 
-sst::block_handle sstable_builder::flush_block_(std::string_view content)
+sst::block_handle sstable_builder::flush_block_(std::string_view content, compression_type type)
 {
     assert(!content.empty());
 
     const std::uint64_t offset = out_.tellp();
     const std::uint64_t length = content.length();
-    // todo: add crc
+
+    std::string trailer;
+    sst::encode_block_trailer(content, type, &trailer);
 
     out_.write(content.data(), content.size());
+    out_.write(trailer.data(), trailer.size());
+    size_in_bytes_ += length + trailer.size();
 
     return sst::block_handle{ offset, length };
 }
 
-sst::block_handle sstable_builder::flush_metablock_()
+sst::block_handle sstable_builder::flush_metablock_(std::optional<sst::block_handle> filter, bool index_partitioned, std::string_view model)
 {
     block_builder metablock(options_);
 
@@ -91,7 +125,26 @@ sst::block_handle sstable_builder::flush_metablock_()
     metablock.add(sst::metablock_last_key, last_key_);
     metablock.add(sst::metablock_entry_count, buf);
 
-    return flush_block_(metablock.done());
+    if (filter) {
+        std::string handle_buf;
+        filter->encode_to(&handle_buf);
+        metablock.add(sst::metablock_filter, handle_buf);
+    }
+    if (index_partitioned) {
+        metablock.add(sst::metablock_index_partitioned, {});
+    }
+    if (!model.empty()) {
+        metablock.add(sst::metablock_index_model, model);
+    }
+    if (!blob_files_.empty()) {
+        std::string ids;
+        for (const auto id: blob_files_) {
+            PutFixed64(&ids, id);
+        }
+        metablock.add(sst::metablock_blob_files, ids);
+    }
+
+    return flush_block_(metablock.done(), compression_type::none);
 }
 
 void sstable_builder::commit_datablock_()
@@ -99,13 +152,49 @@ void sstable_builder::commit_datablock_()
     assert(datablock_.size_in_bytes() > 0);
     assert(!last_key_.empty());
 
-    auto handle = flush_block_(datablock_.done());
+    const auto raw = datablock_.done();
+
+    std::string_view content = raw;
+    auto type = compression_type::none;
+    if (options_.compression != compression_type::none) {
+        compressed_.clear();
+        compress(options_.compression, raw, &compressed_);
+
+        // blocks barely shrinking are not worth decompressing on reads
+        if (compressed_.size() * options_.min_compression_ratio <= raw.size()) {
+            content = compressed_;
+            type = options_.compression;
+        }
+    }
+
+    auto handle = flush_block_(content, type);
 
     std::string buf;
     handle.encode_to(&buf);
     datablock_index_.add(last_key_, buf);
+    if (options_.index_model && options_.index_partition_size == 0) {
+        model_.add(extract_user_key(last_key_));
+    }
 
     datablock_.reset();
+
+    if (options_.index_partition_size > 0 && datablock_index_.size_in_bytes() >= options_.index_partition_size) {
+        commit_index_partition_();
+    }
+}
+
+void sstable_builder::commit_index_partition_()
+{
+    assert(datablock_index_.size_in_bytes() > 0);
+
+    // partitions end with the last key of their last data block
+    auto handle = flush_block_(datablock_index_.done(), compression_type::none);
+
+    std::string buf;
+    handle.encode_to(&buf);
+    top_index_.add(last_key_, buf);
+
+    datablock_index_.reset();
 }
 
 void sstable_builder::flush_pending_block_()
@@ -119,8 +208,19 @@ void sstable_builder::flush_pending_block_()
 
 void sstable_builder::flush_footer_()
 {
-    auto dataindex_handle = flush_block_(datablock_index_.done());
-    auto meta_handle = flush_metablock_();
+    const bool partitioned = options_.index_partition_size > 0;
+    if (partitioned && datablock_index_.size_in_bytes() > 0) {
+        commit_index_partition_();
+    }
+
+    auto dataindex_handle = flush_block_(partitioned ? top_index_.done() : datablock_index_.done(), compression_type::none);
+
+    std::optional<sst::block_handle> filter_handle;
+    if (!filter_.empty()) {
+        filter_handle = flush_block_(filter_.done(), compression_type::none);
+    }
+
+    auto meta_handle = flush_metablock_(filter_handle, partitioned, model_.done());
 
     sst::footer foot(dataindex_handle, meta_handle);
 
@@ -4,8 +4,11 @@
 #include <optional>
 #include <memory>
 #include <fstream>
+#include <set>
 #include "sstable/sstable.h"
 #include "sstable/block_builder.h"
+#include "sstable/bloom_filter.h"
+#include "sstable/index_model.h"
 #include "sstable/format.h"
 
 namespace cloudkv {
@@ -13,32 +16,37 @@ namespace cloudkv {
 /**
  * @brief simple format: sorted string list
  *
- * [block1]
+ * [block1]       data blocks are compressed with options.compression
  * [block2]
  * [block3]
  * ...
- * [datablock index]
+ * [datablock index]  or index partitions followed by the top level index on their last keys
+ * [filter block]   bloom filter on user keys, optional
  * [metablock]
  * [footer]
  *      [datablock index handle]
  *      [metablockhandle]
  *      ...
  *
+ * keys added are internal keys, see kv_format.h, blob files referred to by blob_index entries are listed in metablock
+ *
  * basic guarantee
  */
 class sstable_builder {
 public:
     // todo: remove this
     explicit sstable_builder(const options& opts, std::ostream& out);
+    // written by O_DIRECT if opts.use_direct_io
     explicit sstable_builder(const options& opts, const path_t& p);
 
     void add(std::string_view key, std::string_view value);
 
     void done();
 
+    // bytes written plus the pending block, as keys are compressed
     std::uint64_t size_in_bytes() const
     {
-        return size_in_bytes_;
+        return size_in_bytes_ + datablock_.size_in_bytes();
     }
 
     const path_t& target() const
@@ -47,26 +55,33 @@ public:
     }
 
 private:
-    sst::block_handle flush_block_(std::string_view content);
-    sst::block_handle flush_metablock_();
+    sst::block_handle flush_block_(std::string_view content, compression_type type);
+    sst::block_handle flush_metablock_(std::optional<sst::block_handle> filter, bool index_partitioned, std::string_view model);
 
     void commit_datablock_();
+    void commit_index_partition_();
     void flush_pending_block_();
     void flush_footer_();
 
 private:
-    const options& options_;
+    const options options_;
     const path_t path_;
-    std::unique_ptr<std::ofstream> buf_;
+    std::unique_ptr<std::streambuf> filebuf_;  // direct_filebuf or std::filebuf
+    std::unique_ptr<std::ostream> buf_;
     std::ostream& out_;
 
     block_builder datablock_;
-    block_builder datablock_index_;
+    std::string compressed_;
+    block_builder datablock_index_;  // a restart per entry, to binary search all keys
+    block_builder top_index_;  // over index partitions, if partitioned
+    bloom_filter_builder filter_;
+    index_model_builder model_;
 
-    std::uint64_t size_in_bytes_ = 0;
+    std::uint64_t size_in_bytes_ = 0;  // flushed
     std::uint64_t entry_count_ = 0;
     std::string first_key_;
     std::string last_key_;
+    std::set<std::uint64_t> blob_files_;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include <algorithm>
+#include "sstable/sstable_index.h"
+
+using namespace cloudkv;
+
+sstable_index::sstable_index(const std::vector<sstable_ptr>& sstables)
+    : sstables_(sstables.rbegin(), sstables.rend())
+{
+    entries_.reserve(sstables_.size());
+    for (std::uint32_t age = 0; age < sstables_.size(); ++age) {
+        const auto& sst = sstables_[age];
+        entries_.push_back({ extract_user_key(sst->min()), extract_user_key(sst->max()), age });
+    }
+
+    std::sort(entries_.begin(), entries_.end(), [](const entry& x, const entry& y){
+        return x.min < y.min;
+    });
+
+    max_so_far_.reserve(entries_.size());
+    for (const auto& e: entries_) {
+        max_so_far_.push_back(max_so_far_.empty()? e.max: std::max(max_so_far_.back(), e.max));
+    }
+}
+
+std::vector<sstable_ptr> sstable_index::covering(user_key_ref key) const
+{
+    const auto end = std::upper_bound(entries_.begin(), entries_.end(), key, [](user_key_ref k, const entry& e){
+        return k < e.min;
+    });
+
+    return collect_(end - entries_.begin(), key);
+}
+
+std::vector<sstable_ptr> sstable_index::overlapping(user_key_ref lower, user_key_ref upper) const
+{
+    auto end = entries_.end();
+    if (!upper.empty()) {
+        end = std::lower_bound(entries_.begin(), entries_.end(), upper, [](const entry& e, user_key_ref k){
+            return e.min < k;
+        });
+    }
+
+    return collect_(end - entries_.begin(), lower);
+}
+
+std::vector<sstable_ptr> sstable_index::collect_(std::size_t end, user_key_ref lower) const
+{
+    // every entry in [0, end) starts early enough, keep those ending late enough
+    std::vector<std::uint32_t> ages;
+    for (auto i = end; i > 0 && max_so_far_[i - 1] >= lower; --i) {
+        const auto& e = entries_[i - 1];
+        if (e.max >= lower) {
+            ages.push_back(e.age);
+        }
+    }
+
+    std::sort(ages.begin(), ages.end());
+
+    std::vector<sstable_ptr> result;
+    result.reserve(ages.size());
+    for (const auto age: ages) {
+        result.push_back(sstables_[age]);
+    }
+
+    return result;
+}
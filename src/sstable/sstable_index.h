@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "sstable/sstable.h"
+#include "kv_format.h"
+
+namespace cloudkv {
+
+/**
+ * @brief immutable index over user key ranges of sstables
+ *
+ * entries are sorted by min user key, along with the running max of max user keys,
+ * so a probe stops as soon as no earlier sstable could reach the key.
+ * for disjoint sstables, a probe is O(logN)
+ */
+class sstable_index {
+public:
+    // sstables from the oldest to the newest, as in metainfo
+    explicit sstable_index(const std::vector<sstable_ptr>& sstables);
+
+    // newest first
+    const std::vector<sstable_ptr>& all() const
+    {
+        return sstables_;
+    }
+
+    // sstables whose range covers key, newest first
+    std::vector<sstable_ptr> covering(user_key_ref key) const;
+
+    // sstables whose range overlaps [lower, upper), newest first, empty bound means unbounded
+    std::vector<sstable_ptr> overlapping(user_key_ref lower, user_key_ref upper) const;
+
+private:
+    std::vector<sstable_ptr> collect_(std::size_t end, user_key_ref lower) const;
+
+private:
+    struct entry {
+        user_key_ref min;
+        user_key_ref max;
+        std::uint32_t age;  // 0 for the newest
+    };
+
+    std::vector<sstable_ptr> sstables_;
+    std::vector<entry> entries_;
+    std::vector<user_key_ref> max_so_far_;
+};
+
+using sstable_index_ptr = std::shared_ptr<const sstable_index>;
+
+}
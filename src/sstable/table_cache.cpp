@@ -0,0 +1,80 @@
+#include <mutex>
+#include "sstable/table_cache.h"
+
+using namespace cloudkv;
+
+table_cache::table_cache(std::uint64_t max_open_sstables, const table_reader_options& opts, std::uint64_t pin_budget)
+    : reader_options_(opts),
+      cache_(max_open_sstables),
+      pin_budget_(pin_budget)
+{
+}
+
+table_reader_ptr table_cache::get(const sstable& sst)
+{
+    if (pin_budget_ > 0) {
+        std::shared_lock _(pin_mut_);
+        if (auto it = pinned_.find(sst.id()); it != pinned_.end()) {
+            return it->second.reader;
+        }
+    }
+
+    if (auto reader = cache_.find(sst.id())) {
+        return reader;
+    }
+
+    // opening races are harmless, the later one wins
+    auto reader = sst.make_reader(reader_options_);
+    cache_.insert(sst.id(), reader, 1);
+
+    return reader;
+}
+
+bool table_cache::pin(const sstable& sst)
+{
+    if (pin_budget_ == 0) {
+        return false;
+    }
+
+    {
+        std::shared_lock _(pin_mut_);
+        if (pinned_.count(sst.id())) {
+            return true;
+        }
+    }
+
+    // opened outside the lock, the index is loaded and verified
+    auto reader = cache_.find(sst.id());
+    if (!reader) {
+        reader = sst.make_reader(reader_options_);
+    }
+    const auto charge = reader->index_size_in_bytes() + sst.filter_size_in_bytes();
+
+    std::unique_lock _(pin_mut_);
+    if (pinned_.count(sst.id())) {
+        return true;
+    }
+    if (pinned_bytes_ + charge > pin_budget_) {
+        return false;
+    }
+
+    pinned_.emplace(sst.id(), pinned_reader{ std::move(reader), charge });
+    pinned_bytes_ += charge;
+    _.unlock();
+
+    cache_.erase(sst.id());
+    return true;
+}
+
+void table_cache::evict(const sstable& sst)
+{
+    if (pin_budget_ > 0) {
+        std::unique_lock _(pin_mut_);
+        if (auto it = pinned_.find(sst.id()); it != pinned_.end()) {
+            pinned_bytes_ -= it->second.charge;
+            pinned_.erase(it);
+        }
+    }
+
+    cache_.erase(sst.id());
+}
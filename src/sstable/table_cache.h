@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <shared_mutex>
+#include <unordered_map>
+#include "core.h"
+#include "sstable/sstable.h"
+#include "sstable/table_reader.h"
+#include "util/lru_cache.h"
+
+namespace cloudkv {
+
+/**
+ * @brief keep sstables opened, so lookups need neither open/stat nor index loading
+ *
+ * readers of pinned sstables are kept out of the lru until evicted, charged by their index and filter
+ * against pin_budget bytes, so lookups of them only read data blocks
+ *
+ * thread safe
+ */
+class table_cache : private noncopyable {
+public:
+    explicit table_cache(std::uint64_t max_open_sstables, const table_reader_options& opts = {}, std::uint64_t pin_budget = 0);
+
+    table_reader_ptr get(const sstable& sst);
+
+    // open the sstable and keep it, false if over budget, in which case it is cached as others
+    bool pin(const sstable& sst);
+
+    // pinned ones are released too, readers in use keep valid
+    void evict(const sstable& sst);
+
+    std::uint64_t pinned_bytes() const
+    {
+        std::shared_lock _(pin_mut_);
+        return pinned_bytes_;
+    }
+
+    // null if lookups read blocks one by one
+    async_io* io() const
+    {
+        return reader_options_.io;
+    }
+
+    std::uint64_t open_count()
+    {
+        return cache_.total_charge();
+    }
+
+private:
+    struct pinned_reader {
+        table_reader_ptr reader;
+        std::uint64_t charge;
+    };
+
+    const table_reader_options reader_options_;
+    lru_cache<std::uint64_t, table_reader> cache_;
+
+    const std::uint64_t pin_budget_;
+    mutable std::shared_mutex pin_mut_;
+    std::unordered_map<std::uint64_t, pinned_reader> pinned_;
+    std::uint64_t pinned_bytes_ = 0;
+};
+
+}
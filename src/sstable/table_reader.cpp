@@ -0,0 +1,315 @@
+#include <cassert>
+#include <fmt/core.h>
+#include "cloudkv/exception.h"
+#include "sstable/table_reader.h"
+#include "util/fmt_std.h"
+
+using namespace cloudkv;
+
+namespace {
+
+block load_index(const random_access_file& file, sst::block_handle dataindex, bool has_block_trailer)
+{
+    std::string buf;
+    const auto content = sst::read_block_content(file, dataindex, has_block_trailer, true, &buf);
+    if (content.data() != buf.data()) {
+        // the mapping lives as long as the reader
+        return block(content, nullptr);
+    }
+
+    buf.resize(content.size());
+    return block(std::move(buf));
+}
+
+}
+
+// iterates index partitions one by one, as the single level index does
+class table_reader::partitioned_index_iter : public kv_iter {
+public:
+    explicit partitioned_index_iter(std::shared_ptr<const table_reader> reader)
+        : reader_(std::move(reader)), top_iter_(reader_->index_block_.iter())
+    {
+    }
+
+    void seek_first() override
+    {
+        top_iter_->seek_first();
+        if (load_partition_()) {
+            partition_iter_->seek_first();
+            skip_empty_partitions_();
+        }
+    }
+
+    void seek(std::string_view key) override
+    {
+        top_iter_->seek(key);
+        if (load_partition_()) {
+            partition_iter_->seek(key);
+            skip_empty_partitions_();
+        }
+    }
+
+    void seek_last() override
+    {
+        top_iter_->seek_last();
+        if (load_partition_()) {
+            partition_iter_->seek_last();
+            skip_empty_partitions_backward_();
+        }
+    }
+
+    void seek_for_prev(std::string_view key) override
+    {
+        // the result is in the first partition whose last key is not less than key, or the one before
+        top_iter_->seek(key);
+        if (top_iter_->is_eof()) {
+            seek_last();
+            return;
+        }
+
+        load_partition_();
+        partition_iter_->seek_for_prev(key);
+        skip_empty_partitions_backward_();
+    }
+
+    bool is_eof() override
+    {
+        return !partition_iter_ || partition_iter_->is_eof();
+    }
+
+    void next() override
+    {
+        assert(!is_eof());
+
+        partition_iter_->next();
+        skip_empty_partitions_();
+    }
+
+    void prev() override
+    {
+        assert(!is_eof());
+
+        partition_iter_->prev();
+        skip_empty_partitions_backward_();
+    }
+
+    key_value_pair current() override
+    {
+        assert(!is_eof());
+        return partition_iter_->current();
+    }
+
+private:
+    bool load_partition_()
+    {
+        partition_iter_.reset();
+        partition_.reset();
+        if (top_iter_->is_eof()) {
+            return false;
+        }
+
+        partition_ = reader_->read_block(sst::block_handle(top_iter_->current().value), true);
+        partition_iter_ = partition_->iter();
+        return true;
+    }
+
+    void skip_empty_partitions_()
+    {
+        while (partition_iter_ && partition_iter_->is_eof()) {
+            top_iter_->next();
+            if (load_partition_()) {
+                partition_iter_->seek_first();
+            }
+        }
+    }
+
+    void skip_empty_partitions_backward_()
+    {
+        while (partition_iter_ && partition_iter_->is_eof()) {
+            top_iter_->prev();
+            if (load_partition_()) {
+                partition_iter_->seek_last();
+            }
+        }
+    }
+
+private:
+    const std::shared_ptr<const table_reader> reader_;
+    const iter_ptr top_iter_;
+
+    block_ptr partition_;
+    iter_ptr partition_iter_;
+};
+
+table_reader::table_reader(const path_t& p, std::uint64_t sst_id, sst::block_handle dataindex, bool has_block_trailer, bool index_partitioned, const table_reader_options& opts)
+    : file_(p, opts.use_mmap, opts.hint, opts.use_direct_io),
+      sst_id_(sst_id),
+      has_block_trailer_(has_block_trailer),
+      index_partitioned_(index_partitioned),
+      index_block_(load_index(file_, dataindex, has_block_trailer)),
+      block_cache_(opts.cache)
+{
+}
+
+std::uint64_t table_reader::read_size_(sst::block_handle handle) const
+{
+    const auto size = sst::block_read_size(handle, has_block_trailer_);
+    if (file_.size() < handle.offset() + size) {
+        throw data_corrupted{ fmt::format("block handle {}+{} out of file {}", handle.offset(), handle.length(), file_.path()) };
+    }
+
+    return size;
+}
+
+block_ptr table_reader::load_block_(sst::block_handle handle, bool verify_checksums, std::string_view* mapped, readahead_buffer* readahead) const
+{
+    if (block_cache_) {
+        if (auto blk = block_cache_->find(sst_id_, handle.offset())) {
+            return blk;
+        }
+    }
+
+    std::string buf;
+    if (!readahead) {
+        const auto raw = file_.read(handle.offset(), read_size_(handle), &buf);
+        return make_block_(handle, raw, verify_checksums, &buf, mapped);
+    }
+
+    // blocks own their content, so those read ahead are copied out of the shared buffer
+    const auto raw = readahead->read(file_, handle.offset(), read_size_(handle), &buf);
+    if (file_.is_mmaped() || raw.data() == buf.data()) {
+        return make_block_(handle, raw, verify_checksums, &buf, mapped);
+    }
+
+    buf.assign(raw);
+    return make_block_(handle, buf, verify_checksums, &buf, mapped);
+}
+
+block_ptr table_reader::make_block_(sst::block_handle handle, std::string_view raw, bool verify_checksums, std::string* buf, std::string_view* mapped) const
+{
+    const auto content = sst::decode_block_content(file_, raw, handle, has_block_trailer_, verify_checksums, buf);
+    if (content.data() != buf->data()) {
+        assert(file_.is_mmaped());
+
+        *mapped = content;
+        return nullptr;
+    }
+
+    buf->resize(content.size());
+
+    // cached blocks are trusted by verifying reads, so unverified ones are not shared
+    auto blk = std::make_shared<const block>(std::move(*buf));
+    if (block_cache_ && (verify_checksums || !has_block_trailer_)) {
+        block_cache_->insert(sst_id_, handle.offset(), blk);
+    }
+
+    return blk;
+}
+
+block_ptr table_reader::read_block(sst::block_handle handle, bool verify_checksums, readahead_buffer* readahead) const
+{
+    std::string_view mapped;
+    if (auto blk = load_block_(handle, verify_checksums, &mapped, readahead)) {
+        return blk;
+    }
+
+    return std::make_shared<const block>(mapped, shared_from_this());
+}
+
+iter_ptr table_reader::index_iter() const
+{
+    if (index_partitioned_) {
+        return std::make_unique<partitioned_index_iter>(shared_from_this());
+    }
+
+    return index_block_.iter();
+}
+
+std::optional<sst::block_handle> table_reader::find_data_block_(std::string_view key, std::string* scratch, std::optional<index_window> predicted) const
+{
+    const auto index_entry = predicted && !index_partitioned_ ?
+        index_block_.lower_bound(key, scratch, predicted->first, predicted->last) :
+        index_block_.lower_bound(key, scratch);
+    if (!index_entry) {
+        return std::nullopt;
+    }
+    if (!index_partitioned_) {
+        return sst::block_handle(index_entry->value);
+    }
+
+    const sst::block_handle partition_handle(index_entry->value);
+
+    std::string_view mapped;
+    auto partition = load_block_(partition_handle, true, &mapped);
+    const auto entry = partition ? partition->lower_bound(key, scratch) : block::lower_bound(mapped, key, scratch);
+    if (!entry) {
+        return std::nullopt;
+    }
+
+    return sst::block_handle(entry->value);
+}
+
+std::optional<lookup_result> table_reader::get(std::string_view user_key, bool verify_checksums, std::string* scratch,
+                                               std::optional<index_window> predicted) const
+{
+    get_context ctx;
+    ctx.user_key = user_key;
+    ctx.verify_checksums = verify_checksums;
+    ctx.scratch = scratch;
+    ctx.predicted = predicted;
+
+    if (start_get(ctx)) {
+        ctx.read.result = file_.read(ctx.read.offset, ctx.read.length, ctx.read.buf);
+    }
+
+    return finish_get(ctx);
+}
+
+bool table_reader::start_get(get_context& ctx) const
+{
+    ctx.handle = find_data_block_(ctx.user_key, ctx.scratch, ctx.predicted);
+    if (!ctx.handle) {
+        return false;
+    }
+
+    const auto handle = *ctx.handle;
+    if (block_cache_) {
+        if ((ctx.block = block_cache_->find(sst_id_, handle.offset()))) {
+            return false;
+        }
+    }
+    if (file_.is_mmaped()) {
+        ctx.block = load_block_(handle, ctx.verify_checksums, &ctx.mapped);
+        return false;
+    }
+
+    ctx.read = read_request{ &file_, handle.offset(), read_size_(handle), &ctx.buf };
+    return true;
+}
+
+std::optional<lookup_result> table_reader::finish_get(get_context& ctx) const
+{
+    if (!ctx.handle) {
+        return std::nullopt;
+    }
+    if (ctx.read.file) {
+        ctx.block = make_block_(*ctx.handle, ctx.read.result, ctx.verify_checksums, &ctx.buf, &ctx.mapped);
+        ctx.read = {};
+    }
+
+    if (!ctx.block) {
+        const auto kv = block::get(ctx.mapped, ctx.user_key, ctx.scratch);
+        if (!kv) {
+            return std::nullopt;
+        }
+
+        return lookup_result{ kv->key, kv->value, shared_from_this() };
+    }
+
+    const auto kv = ctx.block->get(ctx.user_key, ctx.scratch);
+    if (!kv) {
+        return std::nullopt;
+    }
+
+    return lookup_result{ kv->key, kv->value, ctx.block };
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include "core.h"
+#include "sstable/block.h"
+#include "sstable/block_cache.h"
+#include "sstable/format.h"
+#include "sstable/index_model.h"
+#include "util/async_io.h"
+#include "util/random_access_file.h"
+#include "util/readahead_buffer.h"
+
+namespace cloudkv {
+
+struct table_reader_options {
+    // uncompressed blocks are shared through cache if given
+    // raw blocks of mapped files are never cached for they copy nothing
+    block_cache* cache = nullptr;
+    bool use_mmap = false;
+    access_hint hint = access_hint::normal;
+    async_io* io = nullptr;  // reads data blocks of batched lookups at once, see sstable::multi_get
+    bool use_direct_io = false;
+};
+
+// views keep valid as long as pin lives, key may point to the scratch given for lookup instead
+struct lookup_result {
+    std::string_view key;  // internal key
+    std::string_view value;
+    std::shared_ptr<const void> pin;
+};
+
+// a point lookup split around the read of its data block, so reads of many lookups can be in flight together
+struct get_context {
+    std::string_view user_key;
+    bool verify_checksums = true;
+    std::string* scratch = nullptr;
+    std::optional<index_window> predicted;
+
+    // set by table_reader::start_get
+    std::optional<sst::block_handle> handle;  // nullopt if the key is beyond the sstable
+    block_ptr block;  // kept after finish_get, so it can be shared by lookups of the same block
+    std::string_view mapped;
+    read_request read;  // to be done if read.file is set
+    std::string buf;
+};
+
+// an opened sstable with its data index parsed, shared by iterators of the same sstable
+class table_reader : public std::enable_shared_from_this<table_reader>, private noncopyable {
+public:
+    // the data index is always verified, partitioned ones are loaded on demand and cached as data blocks
+    table_reader(const path_t& p, std::uint64_t sst_id, sst::block_handle dataindex, bool has_block_trailer, bool index_partitioned, const table_reader_options& opts = {});
+
+    // over the last key and handle of every data block
+    iter_ptr index_iter() const;
+
+    // of the data index, or its top level if partitioned
+    std::uint64_t index_size_in_bytes() const
+    {
+        return index_block_.size_in_bytes();
+    }
+
+    // mapped blocks keep the reader alive, cached blocks are not verified again
+    // blocks missing in cache are read through readahead if given
+    block_ptr read_block(sst::block_handle handle, bool verify_checksums, readahead_buffer* readahead = nullptr) const;
+
+    // entry of user key, touching one data block at most and building no iterators
+    // scratch is reused to rebuild prefix compressed keys, the data index is searched around the predicted window first
+    std::optional<lookup_result> get(std::string_view user_key, bool verify_checksums, std::string* scratch,
+                                     std::optional<index_window> predicted = std::nullopt) const;
+
+    // same as get, the data block is read by ctx.read in between if start_get returns true
+    bool start_get(get_context& ctx) const;
+    std::optional<lookup_result> finish_get(get_context& ctx) const;
+
+private:
+    class partitioned_index_iter;
+
+    // handle of the data block which may contain key
+    std::optional<sst::block_handle> find_data_block_(std::string_view key, std::string* scratch, std::optional<index_window> predicted) const;
+
+    // of the block with its trailer, checked against the file size
+    std::uint64_t read_size_(sst::block_handle handle) const;
+
+    // return nullptr for raw blocks of mapped files, which are put into mapped instead
+    block_ptr load_block_(sst::block_handle handle, bool verify_checksums, std::string_view* mapped, readahead_buffer* readahead = nullptr) const;
+
+    // decode the block read, which is in either the mapped file or buf, and cache it if possible
+    block_ptr make_block_(sst::block_handle handle, std::string_view raw, bool verify_checksums, std::string* buf, std::string_view* mapped) const;
+
+private:
+    const random_access_file file_;
+    const std::uint64_t sst_id_;
+    const bool has_block_trailer_;
+    const bool index_partitioned_;
+    const block index_block_;
+    block_cache* const block_cache_;
+};
+
+using table_reader_ptr = std::shared_ptr<const table_reader>;
+
+}
@@ -1,7 +1,8 @@
 #include <chrono>
-#include <fstream>
 #include "task/checkpoint_task.h"
 #include "sstable/sstable_builder.h"
+#include "blob/blob_file.h"
+#include "kv_format.h"
 #include "util/fmt_std.h"
 #include "cloudkv/exception.h"
 
@@ -17,21 +18,42 @@ void checkpoint_task::run()
     const auto sst_path = db_path_.sst_path(file_id_alloc_.alloc());
     gc.add(sst_path);
 
-    std::ofstream ofs(sst_path, std::ios::binary);
-    if (!ofs) {
-        throw db_corrupted{ fmt::format("cannot write sst file {}", sst_path) };
-    }
-
-    // fixme
-    sstable_builder builder({}, ofs);
+    sstable_builder builder(opts_, sst_path);
+    std::optional<blob_file_builder> blobs;
+    std::string blob_key;
+    std::string blob_value;
 
     auto it = memtable_->iter();
     for (it->seek_first(); !it->is_eof(); it->next()) {
         const auto kv = it->current();
-        builder.add(kv.key, kv.value);
+        if (opts_.min_blob_size == 0 || kv.value.size() < opts_.min_blob_size || extract_key_type(kv.key) != key_type::value) {
+            builder.add(kv.key, kv.value);
+            continue;
+        }
+
+        // large values are kept apart, so that compactions move their references only
+        if (!blobs) {
+            const auto file_id = file_id_alloc_.alloc();
+            const auto blob_path = db_path_.blob_path(file_id);
+            gc.add(blob_path);
+            blobs.emplace(opts_, blob_path, file_id);
+        }
+
+        blob_key.assign(kv.key);
+        blob_key.back() = static_cast<char>(key_type::blob_index);
+        blob_value.clear();
+        blobs->add(kv.value).encode_to(&blob_value);
+
+        builder.add(blob_key, blob_value);
     }
 
+    // values go first, sstables refer to them
+    std::vector<blob_file_meta> blob_files;
+    if (blobs) {
+        blobs->done();
+        blob_files.push_back(blobs->meta());
+    }
     builder.done();
 
-    notify_success_(std::make_shared<sstable>(sst_path));
+    notify_success_(std::make_shared<sstable>(sst_path), blob_files);
 }
\ No newline at end of file
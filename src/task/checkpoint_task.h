@@ -3,8 +3,10 @@
 #include <functional>
 #include "memtable/memtable.h"
 #include "sstable/sstable.h"
+#include "blob/blob_file.h"
 #include "task/default_task.h"
 #include "path_conf.h"
+#include "cloudkv/options.h"
 #include "file_id_allocator.h"
 #include "gc_root.h"
 
@@ -12,10 +14,12 @@ namespace cloudkv {
 
 class checkpoint_task : public default_task {
 public:
-    using callback_fn = std::function<void(sstable_ptr)>;
+    // with the blob file written if any
+    using callback_fn = std::function<void(sstable_ptr, const std::vector<blob_file_meta>&)>;
 
     struct checkpoint_ctx {
         const path_conf& db_path;
+        const options& opts;
         file_id_allocator& file_id_alloc;
         gc_root& root;
         memtable_ptr memtable;
@@ -24,6 +28,7 @@ public:
 
     checkpoint_task(checkpoint_ctx ctx)
         : db_path_(ctx.db_path),
+          opts_(ctx.opts),
           file_id_alloc_(ctx.file_id_alloc),
           gc_root_(ctx.root),
           memtable_(std::move(ctx.memtable)),
@@ -40,6 +45,7 @@ public:
 
 private:
     const path_conf& db_path_;
+    const options& opts_;
     file_id_allocator& file_id_alloc_;
     gc_root& gc_root_;
     const memtable_ptr memtable_;
@@ -1,7 +1,10 @@
+#include <algorithm>
 #include <cstddef>
 #include <cassert>
 #include <vector>
 #include <fstream>
+#include <unordered_map>
+#include <unordered_set>
 #include <range/v3/view.hpp>
 #include <spdlog/spdlog.h>
 #include "task/compaction_task.h"
@@ -19,28 +22,71 @@ void compaction_task::run()
     auto sstables_to_compaction = choose_files_();
     if (sstables_to_compaction.empty()) {
         spdlog::info("[compaction] no sstables choosed for compaction");
-        notify_success_({}, {});
+        notify_success_({}, {}, {});
         return;
     }
 
     spdlog::info("[compaction] started, {} sst", sstables_to_compaction.size());
     sstable_vec new_sstables;
-    auto iter = std::make_unique<merge_iterator>(sstables_to_compaction | views::transform([](const auto& sst){
-        return sst->iter();
+    auto iter = std::make_unique<merge_iterator>(sstables_to_compaction | views::transform([this](const auto& sst){
+        return sst->iter(opts_.compaction_readahead_size);
     }) | to<std::vector>);
 
     temporary_gc_root gc { gc_root_ };
     std::optional<sstable_builder> builder;
 
+    // all sstables are merged, so outputs are the bottommost
+    auto output_opts = opts_;
+    output_opts.compression = opts_.bottommost_compression;
+
+    // blob files are referred to by sstables merged together only, so their live bytes are all counted here
+    std::unordered_map<std::uint64_t, std::uint64_t> blob_live_bytes;
+    for (const auto& sst: sstables_to_compaction) {
+        for (const auto id: sst->blob_files()) {
+            blob_live_bytes.emplace(id, 0);
+        }
+    }
+
+    // live values of mostly discardable blob files are moved to a new one, the old ones are left to gc
+    std::unordered_set<std::uint64_t> blobs_to_rewrite;
+    for (const auto& b: blob_files_) {
+        if (blob_store_ && blob_live_bytes.count(b.file_id) && b.discardable_bytes >= b.total_bytes * opts_.blob_gc_ratio) {
+            blobs_to_rewrite.insert(b.file_id);
+        }
+    }
+    std::optional<blob_file_builder> blob_builder;
+    std::string blob_scratch;
+    std::string blob_value;
+
     for (iter->seek_first(); !iter->is_eof() && !is_cancelled(); iter->next()) {
         if (!builder) {
             auto filepath = db_path_.sst_path(file_id_alloc_.alloc());
             gc.add(filepath);
-            builder.emplace(opts_, filepath);
+            builder.emplace(output_opts, filepath);
         }
 
         const auto current = iter->current();
-        builder->add(current.key, current.value);
+        std::string_view value = current.value;
+        if (extract_key_type(current.key) == key_type::blob_index) {
+            auto ref = blob_ref::decode(value);
+            if (blobs_to_rewrite.count(ref.file_id)) {
+                if (!blob_builder) {
+                    const auto file_id = file_id_alloc_.alloc();
+                    const auto blob_path = db_path_.blob_path(file_id);
+                    gc.add(blob_path);
+                    blob_builder.emplace(opts_, blob_path, file_id);
+                }
+
+                ref = blob_builder->add(blob_store_->get(ref, true, &blob_scratch));
+                blob_value.clear();
+                ref.encode_to(&blob_value);
+                value = blob_value;
+            } else {
+                blob_live_bytes[ref.file_id] += ref.size;
+            }
+        }
+
+        builder->add(current.key, value);
         if (builder->size_in_bytes() > opts_.sstable_size) {
             builder->done();
 
@@ -52,17 +98,30 @@ void compaction_task::run()
 
     if (is_cancelled()) {
         spdlog::warn("[compaction] task cancelled");
-        notify_success_({}, {});
+        notify_success_({}, {}, {});
         return;
     }
 
+    std::vector<blob_file_meta> blob_files;
+    if (blob_builder) {
+        blob_builder->done();
+        blob_files.push_back(blob_builder->meta());
+    }
+
     if (builder && builder->size_in_bytes() > 0) {
         builder->done();
         new_sstables.push_back(std::make_shared<sstable>(builder->target()));
     }
 
-    spdlog::info("[compaction] completed, {} sst generated", new_sstables.size());
-    notify_success_(new_sstables, sstables_to_compaction);
+    for (const auto& b: blob_files_) {
+        const auto it = blob_live_bytes.find(b.file_id);
+        if (it != blob_live_bytes.end()) {
+            blob_files.push_back({ b.file_id, b.total_bytes, b.total_bytes - std::min(it->second, b.total_bytes) });
+        }
+    }
+
+    spdlog::info("[compaction] completed, {} sst generated, {} blob files rewritten", new_sstables.size(), blobs_to_rewrite.size());
+    notify_success_(new_sstables, sstables_to_compaction, blob_files);
 }
 
 compaction_task::sstable_vec compaction_task::choose_files_()
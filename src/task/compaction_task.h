@@ -2,6 +2,8 @@
 
 #include <functional>
 #include "sstable/sstable.h"
+#include "blob/blob_file.h"
+#include "blob/blob_store.h"
 #include "task/default_task.h"
 #include "path_conf.h"
 #include "cloudkv/options.h"
@@ -13,7 +15,8 @@ namespace cloudkv {
 class compaction_task : public default_task {
 public:
     using sstable_vec = std::vector<sstable_ptr>;
-    using callback_fn = std::function<void(const sstable_vec&, const sstable_vec&)>;
+    // with blob files referred to by inputs recounted and the blob file written if any
+    using callback_fn = std::function<void(const sstable_vec&, const sstable_vec&, const std::vector<blob_file_meta>&)>;
 
     struct compaction_ctx {
         const path_conf& db_path;
@@ -22,6 +25,8 @@ public:
         gc_root& gcroot;
         sstable_vec sstables;
         callback_fn fn;
+        blob_store* blobs = nullptr;  // null if no blob file is rewritten
+        std::vector<blob_file_meta> blob_files = {};  // in meta along with sstables
     };
 
     explicit compaction_task(compaction_ctx ctx)
@@ -30,7 +35,9 @@ public:
           file_id_alloc_(ctx.file_id_alloc),
           gc_root_(ctx.gcroot),
           sstables_(std::move(ctx.sstables)),
-          notify_success_(std::move(ctx.fn))
+          notify_success_(std::move(ctx.fn)),
+          blob_store_(ctx.blobs),
+          blob_files_(std::move(ctx.blob_files))
     {
     }
 
@@ -51,6 +58,8 @@ private:
     gc_root& gc_root_;
     const sstable_vec sstables_;
     const callback_fn notify_success_;
+    blob_store* const blob_store_;
+    const std::vector<blob_file_meta> blob_files_;
 };
 
 }
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <charconv>
 #include <spdlog/spdlog.h>
 #include "task/gc_task.h"
@@ -41,4 +42,30 @@ void gc_task::run()
         spdlog::info("[gc] remove sst {}", p.path());
         fs::remove(p.path());
     }
+
+    // blob, created on demand
+    if (!fs::exists(db_path_.blob_dir())) {
+        return;
+    }
+    for (const auto& p: fs::directory_iterator(db_path_.blob_dir())) {
+        if (gc_root_.is_reachable(p.path())) {
+            continue;
+        }
+
+        // blob.<file_id>
+        const auto ext = p.path().extension().native();
+        std::uint64_t file_id = 0;
+        const auto r = std::from_chars(ext.data() + std::min<std::size_t>(ext.size(), 1), ext.data() + ext.size(), file_id);
+        if (r.ec == std::errc::invalid_argument) {
+            spdlog::warn("[gc] invalid blob {} found, ignored for safety", p.path());
+            continue;
+        }
+
+        if (gc_root_.is_blob_reachable(file_id)) {
+            continue;
+        }
+
+        spdlog::info("[gc] remove blob {}", p.path());
+        fs::remove(p.path());
+    }
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdlib>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include "core.h"
+
+namespace cloudkv {
+
+// of offsets, lengths and buffers of direct io, the logical block size of common devices
+constexpr std::uint64_t direct_io_alignment = 4096;
+
+inline std::uint64_t align_down(std::uint64_t x, std::uint64_t alignment = direct_io_alignment)
+{
+    return x / alignment * alignment;
+}
+
+inline std::uint64_t align_up(std::uint64_t x, std::uint64_t alignment = direct_io_alignment)
+{
+    return align_down(x + alignment - 1, alignment);
+}
+
+class aligned_buffer : private noncopyable {
+public:
+    explicit aligned_buffer(std::size_t size, std::size_t alignment = direct_io_alignment)
+        : data_(static_cast<char*>(std::aligned_alloc(alignment, align_up(size, alignment)))),
+          size_(size)
+    {
+        if (!data_) {
+            throw std::bad_alloc{};
+        }
+    }
+
+    char* data() const
+    {
+        return data_.get();
+    }
+
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+private:
+    struct deleter {
+        void operator()(char* p) const
+        {
+            std::free(p);
+        }
+    };
+
+    std::unique_ptr<char, deleter> data_;
+    std::size_t size_;
+};
+
+}
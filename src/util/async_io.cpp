@@ -0,0 +1,473 @@
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <boost/thread/executors/basic_thread_pool.hpp>
+#include <fmt/core.h>
+#include <spdlog/spdlog.h>
+#include "cloudkv/exception.h"
+#include "util/aligned_buffer.h"
+#include "util/async_io.h"
+#include "util/exception_util.h"
+#include "util/fmt_std.h"
+
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#include <linux/io_uring.h>
+#define CLOUDKV_HAS_IO_URING 1
+#endif
+
+using namespace cloudkv;
+
+namespace {
+
+// reads of mapped files copy nothing and are done in place
+bool read_mapped(read_request& r)
+{
+    if (!r.file->is_mmaped()) {
+        return false;
+    }
+
+    r.result = r.file->read(r.offset, r.length, r.buf);
+    return true;
+}
+
+class thread_pool_io : public async_io {
+public:
+    explicit thread_pool_io(std::uint32_t queue_depth)
+        : pool_(queue_depth)
+    {
+    }
+
+    void read(std::vector<read_request>& requests) override
+    {
+        std::mutex mut;
+        std::condition_variable cv;
+        std::size_t remaining = 0;
+        std::exception_ptr error;
+
+        for (auto& r: requests) {
+            if (read_mapped(r)) {
+                continue;
+            }
+
+            {
+                std::lock_guard<std::mutex> _(mut);
+                ++remaining;
+            }
+
+            pool_.submit([&, req = &r] {
+                std::exception_ptr e;
+                try {
+                    req->result = req->file->read(req->offset, req->length, req->buf);
+                } catch (...) {
+                    e = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> _(mut);
+                if (e && !error) {
+                    error = e;
+                }
+                if (--remaining == 0) {
+                    cv.notify_all();
+                }
+            });
+        }
+
+        std::unique_lock<std::mutex> lk(mut);
+        cv.wait(lk, [&] { return remaining == 0; });
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    std::string_view name() const override
+    {
+        return "pread";
+    }
+
+private:
+    boost::executors::basic_thread_pool pool_;
+};
+
+#ifdef CLOUDKV_HAS_IO_URING
+
+// a bare io_uring driven by syscalls, used by one thread at a time
+class uring : private noncopyable {
+public:
+    explicit uring(unsigned entries)
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+
+        fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ < 0) {
+            throw_system_error("io_uring_setup failed");
+        }
+
+        try {
+            map_rings_(params);
+        } catch (...) {
+            release_();
+            throw;
+        }
+    }
+
+    ~uring()
+    {
+        release_();
+    }
+
+    // false if the submission queue is full
+    bool prepare_readv(int fd, const iovec* iov, std::uint64_t offset, std::uint64_t user_data)
+    {
+        const auto tail = *sq_tail_;
+        if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) == sq_entries_) {
+            return false;
+        }
+
+        const auto idx = tail & sq_mask_;
+        auto& sqe = sqes_[idx];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READV;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<std::uint64_t>(iov);
+        sqe.len = 1;
+        sqe.off = offset;
+        sqe.user_data = user_data;
+
+        sq_array_[idx] = idx;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        ++to_submit_;
+
+        return true;
+    }
+
+    enum class status {
+        ok,
+        busy,    // the kernel is short of resources or completions for now, reap before trying again
+        failed,  // the ring is unusable, errno is kept
+    };
+
+    // submit prepared reads and wait for at least one completion
+    status submit_and_wait()
+    {
+        return enter_(to_submit_);
+    }
+
+    // wait for at least one completion without submitting
+    status wait()
+    {
+        return enter_(0);
+    }
+
+    // forget prepared reads the kernel has not seen, the ring must not be reused then
+    unsigned abandon_unsubmitted()
+    {
+        return std::exchange(to_submit_, 0);
+    }
+
+    bool pop_completion(std::uint64_t* user_data, int* res)
+    {
+        const auto head = *cq_head_;
+        if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+            return false;
+        }
+
+        const auto& cqe = cqes_[head & cq_mask_];
+        *user_data = cqe.user_data;
+        *res = cqe.res;
+
+        __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+private:
+    status enter_(unsigned to_submit)
+    {
+        for (;;) {
+            const auto r = ::syscall(__NR_io_uring_enter, fd_, to_submit, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (r >= 0) {
+                to_submit_ -= std::min<unsigned>(to_submit_, r);
+                return status::ok;
+            }
+            if (errno == EAGAIN || errno == EBUSY) {
+                return status::busy;
+            }
+            if (errno != EINTR) {
+                return status::failed;
+            }
+        }
+    }
+
+    void map_rings_(const io_uring_params& p)
+    {
+        sq_ring_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = p.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) {
+            sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        }
+
+        sq_ring_ = map_(sq_ring_size_, IORING_OFF_SQ_RING);
+        cq_ring_ = single_mmap? sq_ring_: map_(cq_ring_size_, IORING_OFF_CQ_RING);
+        sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(map_(sqes_size_, IORING_OFF_SQES));
+
+        auto sq = static_cast<char*>(sq_ring_);
+        sq_head_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sq_entries_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_entries);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+
+        auto cq = static_cast<char*>(cq_ring_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+    }
+
+    void* map_(std::size_t size, std::uint64_t offset)
+    {
+        void* addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+        if (addr == MAP_FAILED) {
+            throw_system_error("mmap io_uring failed");
+        }
+
+        return addr;
+    }
+
+    void release_()
+    {
+        if (sqes_) {
+            ::munmap(sqes_, sqes_size_);
+        }
+        if (cq_ring_ && cq_ring_ != sq_ring_) {
+            ::munmap(cq_ring_, cq_ring_size_);
+        }
+        if (sq_ring_) {
+            ::munmap(sq_ring_, sq_ring_size_);
+        }
+        ::close(fd_);
+    }
+
+private:
+    int fd_ = -1;
+    unsigned to_submit_ = 0;
+
+    void* sq_ring_ = nullptr;
+    void* cq_ring_ = nullptr;
+    std::size_t sq_ring_size_ = 0;
+    std::size_t cq_ring_size_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    std::size_t sqes_size_ = 0;
+
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned cq_mask_ = 0;
+};
+
+class io_uring_io : public async_io {
+public:
+    explicit io_uring_io(std::uint32_t queue_depth)
+        : queue_depth_(queue_depth)
+    {
+        // fail early if the kernel refuses
+        free_.push_back(std::make_unique<uring>(queue_depth_));
+    }
+
+    void read(std::vector<read_request>& requests) override
+    {
+        // direct files are read by pages covering the request into aligned buffers, the last page may be cut by eof
+        struct pending {
+            iovec iov;
+            char* buf = nullptr;
+            std::uint64_t offset = 0;
+            std::uint64_t length = 0;  // bytes needed
+            std::uint64_t max_length = 0;
+            std::uint64_t done = 0;
+            std::unique_ptr<aligned_buffer> aligned;
+        };
+
+        std::vector<std::size_t> queue;
+        std::vector<pending> states(requests.size());
+        for (std::size_t i = 0; i < requests.size(); ++i) {
+            auto& r = requests[i];
+            if (read_mapped(r)) {
+                continue;
+            }
+
+            r.file->check_range(r.offset, r.length);
+            r.buf->resize(r.length);
+            r.result = *r.buf;
+            if (r.length == 0) {
+                continue;
+            }
+
+            auto& s = states[i];
+            if (r.file->is_direct()) {
+                s.offset = align_down(r.offset);
+                s.length = r.offset + r.length - s.offset;
+                s.max_length = align_up(r.offset + r.length) - s.offset;
+                s.aligned = std::make_unique<aligned_buffer>(s.max_length);
+                s.buf = s.aligned->data();
+            } else {
+                s.offset = r.offset;
+                s.length = s.max_length = r.length;
+                s.buf = r.buf->data();
+            }
+            queue.push_back(i);
+        }
+        if (queue.empty()) {
+            return;
+        }
+
+        auto ring = acquire_();
+
+        std::exception_ptr error;
+        bool broken = false;  // the ring failed, reads left are done by pread once those in flight are drained
+        std::size_t next = 0;
+        std::uint32_t inflight = 0;
+        while (inflight > 0 || (next < queue.size() && !error && !broken)) {
+            for (; !broken && next < queue.size() && inflight < queue_depth_ && !error; ++next, ++inflight) {
+                const auto i = queue[next];
+                auto& r = requests[i];
+                auto& s = states[i];
+
+                s.iov.iov_base = s.buf + s.done;
+                s.iov.iov_len = s.max_length - s.done;
+                if (!ring->prepare_readv(r.file->fd(), &s.iov, s.offset + s.done, i)) {
+                    break;
+                }
+            }
+
+            const auto status = broken? ring->wait(): ring->submit_and_wait();
+            if (status == uring::status::busy) {
+                std::this_thread::yield();
+            } else if (status == uring::status::failed) {
+                if (broken) {
+                    // reads in flight may still write into buffers about to be freed
+                    spdlog::critical("io_uring_enter failed with {} reads in flight: {}", inflight, std::strerror(errno));
+                    std::terminate();
+                }
+
+                broken = true;
+                inflight -= ring->abandon_unsubmitted();
+            }
+
+            std::uint64_t i;
+            int res;
+            while (ring->pop_completion(&i, &res)) {
+                --inflight;
+
+                auto& r = requests[i];
+                auto& s = states[i];
+                if (res < 0) {
+                    if (!error) {
+                        error = std::make_exception_ptr(io_error(-res, std::system_category(), fmt::format("read {} failed", r.file->path())));
+                    }
+                } else if (res == 0) {
+                    if (!error) {
+                        error = std::make_exception_ptr(data_corrupted{ fmt::format("unexpected eof when reading {}", r.file->path()) });
+                    }
+                } else if ((s.done += res) < s.length) {
+                    // short read, read the rest later
+                    queue.push_back(i);
+                } else if (s.aligned) {
+                    r.buf->assign(s.buf + (r.offset - s.offset), r.length);
+                    r.result = *r.buf;
+                }
+            }
+        }
+
+        if (broken) {
+            // abandoned entries stay in its submission queue
+            ring.reset();
+
+            for (const auto i: queue) {
+                auto& r = requests[i];
+                auto& s = states[i];
+                if (!error && s.done < s.length) {
+                    r.result = r.file->read(r.offset, r.length, r.buf);
+                    s.done = s.length;
+                }
+            }
+        } else {
+            release_(std::move(ring));
+        }
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    std::string_view name() const override
+    {
+        return "io_uring";
+    }
+
+private:
+    std::unique_ptr<uring> acquire_()
+    {
+        {
+            std::lock_guard<std::mutex> _(mut_);
+            if (!free_.empty()) {
+                auto r = std::move(free_.back());
+                free_.pop_back();
+                return r;
+            }
+        }
+
+        return std::make_unique<uring>(queue_depth_);
+    }
+
+    void release_(std::unique_ptr<uring> ring)
+    {
+        std::lock_guard<std::mutex> _(mut_);
+        free_.push_back(std::move(ring));
+    }
+
+private:
+    const std::uint32_t queue_depth_;
+
+    // a ring per concurrent caller, kept for reuse
+    std::mutex mut_;
+    std::vector<std::unique_ptr<uring>> free_;
+};
+
+#endif
+
+}
+
+std::unique_ptr<async_io> cloudkv::make_async_io(std::uint32_t queue_depth, bool prefer_io_uring)
+{
+    queue_depth = std::max<std::uint32_t>(queue_depth, 1);
+
+#ifdef CLOUDKV_HAS_IO_URING
+    if (prefer_io_uring) {
+        try {
+            return std::make_unique<io_uring_io>(queue_depth);
+        } catch (std::system_error&) {
+            // disabled by the kernel or seccomp
+        }
+    }
+#endif
+
+    return std::make_unique<thread_pool_io>(queue_depth);
+}
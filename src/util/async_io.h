@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "core.h"
+#include "util/random_access_file.h"
+
+namespace cloudkv {
+
+// a positional read, result points to the mapped file or buf once done
+struct read_request {
+    const random_access_file* file = nullptr;
+    std::uint64_t offset = 0;
+    std::uint64_t length = 0;
+    std::string* buf = nullptr;
+
+    std::string_view result;
+};
+
+/**
+ * @brief keeps independent reads in flight at once, at most queue_depth of them
+ *
+ * thread safe
+ */
+class async_io : private noncopyable {
+public:
+    virtual ~async_io() = default;
+
+    // return when all reads are done, throw the first failure
+    virtual void read(std::vector<read_request>& requests) = 0;
+
+    virtual std::string_view name() const = 0;
+};
+
+// io_uring if preferred and allowed by the kernel, or a pool of threads doing pread
+std::unique_ptr<async_io> make_async_io(std::uint32_t queue_depth, bool prefer_io_uring = true);
+
+}
@@ -0,0 +1,104 @@
+#include <cassert>
+#include <lz4.h>
+#include <zstd.h>
+#include <fmt/core.h>
+#include "cloudkv/exception.h"
+#include "util/coding.h"
+#include "util/compression.h"
+
+using namespace cloudkv;
+
+namespace {
+
+constexpr int zstd_level = 3;
+
+void lz4_compress(std::string_view input, std::string* out)
+{
+    const auto offset = out->size();
+    out->resize(offset + LZ4_compressBound(input.size()));
+
+    const auto n = LZ4_compress_default(input.data(), out->data() + offset, input.size(), out->size() - offset);
+    assert(n > 0);
+
+    out->resize(offset + n);
+}
+
+void lz4_uncompress(std::string_view input, std::string* out)
+{
+    const auto n = LZ4_decompress_safe(input.data(), out->data(), input.size(), out->size());
+    if (n < 0 || std::size_t(n) != out->size()) {
+        throw data_corrupted{ "lz4 block corrupted" };
+    }
+}
+
+void zstd_compress(std::string_view input, std::string* out)
+{
+    const auto offset = out->size();
+    out->resize(offset + ZSTD_compressBound(input.size()));
+
+    const auto n = ZSTD_compress(out->data() + offset, out->size() - offset, input.data(), input.size(), zstd_level);
+    assert(!ZSTD_isError(n));
+
+    out->resize(offset + n);
+}
+
+void zstd_uncompress(std::string_view input, std::string* out)
+{
+    const auto n = ZSTD_decompress(out->data(), out->size(), input.data(), input.size());
+    if (ZSTD_isError(n) || n != out->size()) {
+        throw data_corrupted{ fmt::format("zstd block corrupted: {}", ZSTD_isError(n)? ZSTD_getErrorName(n): "size mismatch") };
+    }
+}
+
+}
+
+void cloudkv::compress(compression_type type, std::string_view input, std::string* out)
+{
+    PutVarint32(out, input.size());
+
+    switch (type) {
+    case compression_type::none:
+        out->append(input);
+        break;
+
+    case compression_type::lz4:
+        lz4_compress(input, out);
+        break;
+
+    case compression_type::zstd:
+        zstd_compress(input, out);
+        break;
+    }
+}
+
+void cloudkv::uncompress(compression_type type, std::string_view input, std::string* out)
+{
+    std::uint32_t raw_size;
+    const char* p = GetVarint32Ptr(input.data(), input.data() + input.size(), &raw_size);
+    if (!p) {
+        throw data_corrupted{ "invalid compressed block length" };
+    }
+
+    input.remove_prefix(p - input.data());
+    out->resize(raw_size);
+
+    switch (type) {
+    case compression_type::none:
+        if (input.size() != raw_size) {
+            throw data_corrupted{ "block size mismatch" };
+        }
+        out->assign(input);
+        break;
+
+    case compression_type::lz4:
+        lz4_uncompress(input, out);
+        break;
+
+    case compression_type::zstd:
+        zstd_uncompress(input, out);
+        break;
+
+    default:
+        throw data_corrupted{ fmt::format("unknown compression type {}", int(type)) };
+    }
+}
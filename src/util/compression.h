@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include "cloudkv/options.h"
+
+namespace cloudkv {
+
+// append compressed input to out, prefixed with the raw length
+void compress(compression_type type, std::string_view input, std::string* out);
+
+// replace out with the raw data, throw data_corrupted if input is broken
+void uncompress(compression_type type, std::string_view input, std::string* out);
+
+}
@@ -0,0 +1,207 @@
+#include <array>
+#include <cstring>
+#include "util/crc32c.h"
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#define CLOUDKV_CRC32C_X86 1
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define CLOUDKV_CRC32C_ARM 1
+#endif
+
+using namespace cloudkv;
+
+namespace {
+
+// castagnoli polynomial, reversed
+constexpr std::uint32_t poly = 0x82f63b78;
+
+// slicing-by-8 tables, tables[k][b] is the crc of byte b followed by k zero bytes
+using crc_tables = std::array<std::array<std::uint32_t, 256>, 8>;
+
+constexpr crc_tables make_tables()
+{
+    crc_tables t {};
+    for (std::uint32_t b = 0; b < 256; ++b) {
+        std::uint32_t crc = b;
+        for (int i = 0; i < 8; ++i) {
+            crc = (crc >> 1) ^ ((crc & 1)? poly: 0);
+        }
+        t[0][b] = crc;
+    }
+    for (std::uint32_t b = 0; b < 256; ++b) {
+        for (std::size_t k = 1; k < t.size(); ++k) {
+            t[k][b] = (t[k - 1][b] >> 8) ^ t[0][t[k - 1][b] & 0xff];
+        }
+    }
+
+    return t;
+}
+
+constexpr crc_tables tables = make_tables();
+
+std::uint64_t load_u64(const char* p)
+{
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+#if defined(CLOUDKV_CRC32C_X86)
+
+// raw crc register after n zero bytes, without the pre and post inversion
+std::uint32_t extend_zeros(std::uint32_t crc, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        crc = (crc >> 8) ^ tables[0][crc & 0xff];
+    }
+
+    return crc;
+}
+
+// large buffers are split into 3 interleaved streams of stride bytes, as the crc32 instruction
+// has a latency of 3 cycles but a throughput of 1, and merged by shifting the earlier crcs over
+// the later bytes, which is linear and thus table driven
+constexpr std::size_t stride = 256;
+
+struct shift_tables {
+    std::array<std::array<std::uint32_t, 256>, 4> t;
+
+    shift_tables()
+    {
+        for (std::uint32_t b = 0; b < 256; ++b) {
+            for (std::size_t k = 0; k < t.size(); ++k) {
+                t[k][b] = extend_zeros(b << (8 * k), stride);
+            }
+        }
+    }
+
+    std::uint32_t shift(std::uint32_t crc) const
+    {
+        return t[0][crc & 0xff] ^ t[1][(crc >> 8) & 0xff] ^ t[2][(crc >> 16) & 0xff] ^ t[3][crc >> 24];
+    }
+};
+
+const shift_tables stride_shift;
+
+__attribute__((target("sse4.2")))
+std::uint32_t extend_sse42(std::uint32_t init, const char* data, std::size_t n)
+{
+    std::uint64_t crc = ~init;
+    const char* p = data;
+    const char* end = data + n;
+
+    for (; p + 3 * stride <= end; p += 3 * stride) {
+        std::uint64_t crc1 = 0;
+        std::uint64_t crc2 = 0;
+        for (std::size_t i = 0; i < stride; i += 8) {
+            crc = _mm_crc32_u64(crc, load_u64(p + i));
+            crc1 = _mm_crc32_u64(crc1, load_u64(p + stride + i));
+            crc2 = _mm_crc32_u64(crc2, load_u64(p + 2 * stride + i));
+        }
+
+        crc = stride_shift.shift(stride_shift.shift(crc) ^ crc1) ^ crc2;
+    }
+    for (; p + 8 <= end; p += 8) {
+        crc = _mm_crc32_u64(crc, load_u64(p));
+    }
+    for (; p < end; ++p) {
+        crc = _mm_crc32_u8(static_cast<std::uint32_t>(crc), static_cast<std::uint8_t>(*p));
+    }
+
+    return ~static_cast<std::uint32_t>(crc);
+}
+
+bool detect_hardware()
+{
+    return __builtin_cpu_supports("sse4.2");
+}
+
+#elif defined(CLOUDKV_CRC32C_ARM)
+
+std::uint32_t extend_armv8(std::uint32_t init, const char* data, std::size_t n)
+{
+    std::uint32_t crc = ~init;
+    const char* p = data;
+    const char* end = data + n;
+
+    for (; p + 8 <= end; p += 8) {
+        crc = __crc32cd(crc, load_u64(p));
+    }
+    for (; p < end; ++p) {
+        crc = __crc32cb(crc, static_cast<std::uint8_t>(*p));
+    }
+
+    return ~crc;
+}
+
+bool detect_hardware()
+{
+    return true;
+}
+
+#else
+
+bool detect_hardware()
+{
+    return false;
+}
+
+#endif
+
+using extend_fn = std::uint32_t(*)(std::uint32_t, const char*, std::size_t);
+
+extend_fn choose_extend()
+{
+    if (!detect_hardware()) {
+        return crc32c::extend_portable;
+    }
+
+#if defined(CLOUDKV_CRC32C_X86)
+    return extend_sse42;
+#elif defined(CLOUDKV_CRC32C_ARM)
+    return extend_armv8;
+#else
+    return crc32c::extend_portable;
+#endif
+}
+
+const extend_fn extend_impl = choose_extend();
+
+}
+
+std::uint32_t crc32c::extend_portable(std::uint32_t init, const char* data, std::size_t n)
+{
+    std::uint32_t crc = ~init;
+    const char* p = data;
+    const char* end = data + n;
+
+    for (; p + 8 <= end; p += 8) {
+        // little endian only, as the rest of the file format
+        const std::uint64_t v = load_u64(p) ^ crc;
+        crc = tables[7][v & 0xff] ^
+              tables[6][(v >> 8) & 0xff] ^
+              tables[5][(v >> 16) & 0xff] ^
+              tables[4][(v >> 24) & 0xff] ^
+              tables[3][(v >> 32) & 0xff] ^
+              tables[2][(v >> 40) & 0xff] ^
+              tables[1][(v >> 48) & 0xff] ^
+              tables[0][v >> 56];
+    }
+    for (; p < end; ++p) {
+        crc = (crc >> 8) ^ tables[0][(crc ^ static_cast<std::uint8_t>(*p)) & 0xff];
+    }
+
+    return ~crc;
+}
+
+std::uint32_t crc32c::extend(std::uint32_t init, const char* data, std::size_t n)
+{
+    return extend_impl(init, data, n);
+}
+
+bool crc32c::is_hardware_accelerated()
+{
+    return extend_impl != extend_portable;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace cloudkv {
+
+namespace crc32c {
+
+// crc32c of concat(A, data), where init is the crc32c of A
+std::uint32_t extend(std::uint32_t init, const char* data, std::size_t n);
+
+inline std::uint32_t value(const char* data, std::size_t n)
+{
+    return extend(0, data, n);
+}
+
+inline std::uint32_t value(std::string_view data)
+{
+    return value(data.data(), data.size());
+}
+
+// table driven, always available, exposed for tests and benchmarks
+std::uint32_t extend_portable(std::uint32_t init, const char* data, std::size_t n);
+
+// whether extend runs on the crc32 instruction of the cpu
+bool is_hardware_accelerated();
+
+// crc of data which embeds crcs is problematic, so stored crcs are masked
+inline constexpr std::uint32_t mask_delta = 0xa282ead8ul;
+
+inline std::uint32_t mask(std::uint32_t crc)
+{
+    return ((crc >> 15) | (crc << 17)) + mask_delta;
+}
+
+inline std::uint32_t unmask(std::uint32_t masked)
+{
+    const std::uint32_t rot = masked - mask_delta;
+    return ((rot >> 17) | (rot << 15));
+}
+
+}
+
+}
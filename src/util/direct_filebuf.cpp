@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <fmt/core.h>
+#include "util/direct_filebuf.h"
+#include "util/exception_util.h"
+#include "util/fmt_std.h"
+
+using namespace cloudkv;
+
+direct_filebuf::direct_filebuf(const path_t& p, std::size_t buffer_size)
+    : path_(p),
+      buf_(align_up(std::max<std::size_t>(buffer_size, direct_io_alignment)))
+{
+    constexpr int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+
+    fd_ = ::open(p.c_str(), flags | O_DIRECT, 0644);
+    if (fd_ < 0 && errno == EINVAL) {
+        fd_ = ::open(p.c_str(), flags, 0644);
+    }
+    if (fd_ < 0) {
+        throw_io_error(fmt::format("create {} failed", p));
+    }
+
+    setp(buf_.data(), buf_.data() + align_up(buf_.size()));
+}
+
+direct_filebuf::~direct_filebuf()
+{
+    sync();
+    ::close(fd_);
+}
+
+direct_filebuf::int_type direct_filebuf::overflow(int_type ch)
+{
+    // the buffer is full and a multiple of pages
+    const auto used = static_cast<std::uint64_t>(pptr() - pbase());
+    if (used > 0) {
+        if (!write_(used)) {
+            return traits_type::eof();
+        }
+
+        flushed_ += used;
+        setp(pbase(), epptr());
+    }
+
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(ch);
+}
+
+int direct_filebuf::sync()
+{
+    const auto used = static_cast<std::uint64_t>(pptr() - pbase());
+    const auto full = align_down(used);
+    const auto tail = used - full;
+    if (used == 0) {
+        return 0;
+    }
+
+    // zero the padding of the last page, which is cut by truncate
+    std::memset(pptr(), 0, align_up(used) - used);
+    if (!write_(align_up(used))) {
+        return -1;
+    }
+    if (::ftruncate(fd_, flushed_ + used) != 0) {
+        return -1;
+    }
+
+    // keep the partial page to rewrite it with what follows
+    std::memmove(pbase(), pbase() + full, tail);
+    flushed_ += full;
+    setp(pbase(), epptr());
+    pbump(static_cast<int>(tail));
+
+    return 0;
+}
+
+direct_filebuf::pos_type direct_filebuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+    if (off != 0 || dir != std::ios_base::cur || !(which & std::ios_base::out)) {
+        return pos_type(off_type(-1));
+    }
+
+    return pos_type(off_type(flushed_ + (pptr() - pbase())));
+}
+
+bool direct_filebuf::write_(std::uint64_t end)
+{
+    assert(end % direct_io_alignment == 0);
+
+    std::uint64_t done = 0;
+    while (done < end) {
+        const auto r = ::pwrite(fd_, pbase() + done, end - done, flushed_ + done);
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        done += r;
+    }
+
+    return true;
+}
+
+std::unique_ptr<std::streambuf> cloudkv::open_output_file(const path_t& p, bool use_direct_io)
+{
+    if (use_direct_io) {
+        return std::make_unique<direct_filebuf>(p);
+    }
+
+    auto buf = std::make_unique<std::filebuf>();
+    if (!buf->open(p, std::ios::out | std::ios::binary | std::ios::trunc)) {
+        throw_io_error(fmt::format("create {} failed", p));
+    }
+
+    return buf;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <streambuf>
+#include "core.h"
+#include "util/aligned_buffer.h"
+
+namespace cloudkv {
+
+/**
+ * @brief output to a new file bypassing page cache, for std::ostream
+ *
+ * writes are buffered and issued in aligned pages, a partial last page is written padded
+ * on sync and the file truncated to the bytes written, so the page is rewritten as it grows.
+ * falls back to buffered io on file systems without O_DIRECT
+ */
+class direct_filebuf : public std::streambuf, private noncopyable {
+public:
+    // throw io_error if the file cannot be created
+    explicit direct_filebuf(const path_t& p, std::size_t buffer_size = 1024 * 1024);
+
+    // pending bytes are written, failures ignored
+    ~direct_filebuf() override;
+
+protected:
+    int_type overflow(int_type ch) override;
+    int sync() override;
+
+    // only for tellp
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+
+private:
+    // write the buffer up to end at file offset flushed_
+    bool write_(std::uint64_t end);
+
+private:
+    const path_t path_;
+    int fd_ = -1;
+    aligned_buffer buf_;
+    std::uint64_t flushed_ = 0;  // file offset of the buffer, aligned
+};
+
+// a new file written by direct_filebuf if use_direct_io, or std::filebuf, throw io_error if it cannot be created
+std::unique_ptr<std::streambuf> open_output_file(const path_t& p, bool use_direct_io);
+
+}
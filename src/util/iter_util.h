@@ -27,12 +27,12 @@ inline std::optional<internal_key_value> query_key(const iter_ptr& iter, std::st
     }
 
     const auto [k, v] = iter->current();
-    auto ikey = internal_key::parse(k);
+    const auto ikey = internal_key_ref::parse(k);
     if (ikey.user_key() != key) {
         return {};
     }
 
-    return std::optional(internal_key_value{ std::move(ikey), std::string(v) });
+    return std::optional(internal_key_value{ internal_key(ikey), std::string(v) });
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <functional>
+#include <boost/noncopyable.hpp>
+
+namespace cloudkv {
+
+/**
+ * @brief sharded lru cache, values are handed out as refcounted handles
+ *
+ * an evicted value keeps valid until the last handle is released
+ * capacity is counted in charges, which are given by the caller, eg. bytes or file handles
+ * string keys are looked up by views into the keys owned by entries, so lookups copy nothing
+ */
+template <class Key>
+using lru_lookup_key_t = std::conditional_t<std::is_same_v<Key, std::string>, std::string_view, Key>;
+
+template <class Key, class Value, class Hash = std::hash<lru_lookup_key_t<Key>>>
+class lru_cache : private boost::noncopyable {
+public:
+    using value_ptr = std::shared_ptr<const Value>;
+    using lookup_key = lru_lookup_key_t<Key>;
+
+    explicit lru_cache(std::uint64_t capacity, std::uint32_t shard_count = 16)
+        : shard_count_(shard_count),
+          shards_(std::make_unique<shard[]>(shard_count))
+    {
+        assert(shard_count > 0);
+
+        for (std::uint32_t i = 0; i < shard_count_; ++i) {
+            shards_[i].capacity = (capacity + shard_count_ - 1) / shard_count_;
+        }
+    }
+
+    // return nullptr if not found
+    value_ptr find(const lookup_key& key)
+    {
+        auto& s = shard_of_(key);
+        std::lock_guard _(s.mut);
+
+        auto it = s.index.find(key);
+        if (it == s.index.end()) {
+            return nullptr;
+        }
+
+        s.lru.splice(s.lru.begin(), s.lru, it->second);
+        return it->second->value;
+    }
+
+    // replace the old one if exists
+    void insert(const Key& key, value_ptr value, std::uint64_t charge)
+    {
+        assert(value);
+
+        auto& s = shard_of_(key);
+        std::lock_guard _(s.mut);
+
+        auto it = s.index.find(key);
+        if (it != s.index.end()) {
+            const auto old = it->second;
+            s.usage -= old->charge;
+            s.index.erase(it);
+            s.lru.erase(old);
+        }
+
+        s.lru.push_front(entry{ key, std::move(value), charge });
+        s.index.emplace(lookup_key(s.lru.front().key), s.lru.begin());
+        s.usage += charge;
+
+        // keep the newest one even if it's larger than capacity
+        while (s.usage > s.capacity && s.lru.size() > 1) {
+            const auto& victim = s.lru.back();
+            s.usage -= victim.charge;
+            s.index.erase(lookup_key(victim.key));
+            s.lru.pop_back();
+        }
+    }
+
+    void erase(const lookup_key& key)
+    {
+        auto& s = shard_of_(key);
+        std::lock_guard _(s.mut);
+
+        auto it = s.index.find(key);
+        if (it == s.index.end()) {
+            return;
+        }
+
+        const auto old = it->second;
+        s.usage -= old->charge;
+        s.index.erase(it);
+        s.lru.erase(old);
+    }
+
+    std::uint64_t total_charge()
+    {
+        std::uint64_t total = 0;
+
+        for (std::uint32_t i = 0; i < shard_count_; ++i) {
+            std::lock_guard _(shards_[i].mut);
+            total += shards_[i].usage;
+        }
+
+        return total;
+    }
+
+private:
+    struct entry {
+        Key key;
+        value_ptr value;
+        std::uint64_t charge;
+    };
+
+    using lru_list = std::list<entry>;
+
+    struct shard {
+        std::mutex mut;
+        lru_list lru;
+        std::unordered_map<lookup_key, typename lru_list::iterator, Hash> index;  // keys may point into lru
+        std::uint64_t usage = 0;
+        std::uint64_t capacity = 0;
+    };
+
+    shard& shard_of_(const lookup_key& key)
+    {
+        return shards_[Hash{}(key) % shard_count_];
+    }
+
+private:
+    const std::uint32_t shard_count_;
+    std::unique_ptr<shard[]> shards_;
+};
+
+}
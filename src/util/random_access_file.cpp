@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <cassert>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fmt/core.h>
+#include "cloudkv/exception.h"
+#include "util/fmt_std.h"
+#include "util/aligned_buffer.h"
+#include "util/exception_util.h"
+#include "util/random_access_file.h"
+
+using namespace cloudkv;
+
+namespace {
+
+int to_madvise(access_hint hint)
+{
+    switch (hint) {
+    case access_hint::random:
+        return MADV_RANDOM;
+    case access_hint::sequential:
+        return MADV_SEQUENTIAL;
+    default:
+        return MADV_NORMAL;
+    }
+}
+
+int to_fadvise(access_hint hint)
+{
+    switch (hint) {
+    case access_hint::random:
+        return POSIX_FADV_RANDOM;
+    case access_hint::sequential:
+        return POSIX_FADV_SEQUENTIAL;
+    default:
+        return POSIX_FADV_NORMAL;
+    }
+}
+
+}
+
+random_access_file::random_access_file(const path_t& p, bool use_mmap, access_hint hint, bool use_direct_io)
+    : path_(p)
+{
+    if (use_direct_io) {
+        fd_ = ::open(p.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT);
+        direct_ = fd_ >= 0;
+        use_mmap = use_mmap && !direct_;
+    }
+    if (fd_ < 0) {
+        fd_ = ::open(p.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    if (fd_ < 0) {
+        throw_io_error(fmt::format("open {} failed", p));
+    }
+
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        ::close(fd_);
+        throw_io_error(fmt::format("stat {} failed", p));
+    }
+
+    size_ = st.st_size;
+
+    if (use_mmap && size_ > 0) {
+        void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd_);
+            throw_io_error(fmt::format("mmap {} failed", p));
+        }
+
+        mapped_ = static_cast<const char*>(addr);
+
+        // hints only, ignore failures
+        ::madvise(addr, size_, to_madvise(hint));
+    } else {
+        ::posix_fadvise(fd_, 0, 0, to_fadvise(hint));
+    }
+}
+
+random_access_file::~random_access_file()
+{
+    assert(fd_ >= 0);
+
+    if (mapped_) {
+        ::munmap(const_cast<char*>(mapped_), size_);
+    }
+    ::close(fd_);
+}
+
+void random_access_file::check_range(std::uint64_t offset, std::uint64_t length) const
+{
+    if (offset + length > size_) {
+        throw data_corrupted{ fmt::format("read [{}, {}) out of range in {}, size={}", offset, offset + length, path_, size_) };
+    }
+}
+
+void random_access_file::will_need(std::uint64_t offset, std::uint64_t length) const
+{
+    // hints only, ignore failures
+    if (mapped_) {
+        const auto page = static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+        const auto begin = offset / page * page;
+        if (begin < size_) {
+            ::madvise(const_cast<char*>(mapped_) + begin, std::min(offset + length, size_) - begin, MADV_WILLNEED);
+        }
+    } else {
+        ::posix_fadvise(fd_, offset, length, POSIX_FADV_WILLNEED);
+    }
+}
+
+std::string_view random_access_file::read(std::uint64_t offset, std::uint64_t length, std::string* scratch) const
+{
+    check_range(offset, length);
+
+    if (mapped_) {
+        return { mapped_ + offset, length };
+    }
+
+    if (direct_) {
+        // pages covering the range, the last one may be cut by eof
+        const auto begin = align_down(offset);
+        aligned_buffer buf(align_up(offset + length) - begin);
+        pread_(buf.data(), offset + length - begin, begin, buf.size());
+
+        scratch->assign(buf.data() + (offset - begin), length);
+        return *scratch;
+    }
+
+    scratch->resize(length);
+    pread_(scratch->data(), length, offset, length);
+
+    return *scratch;
+}
+
+void random_access_file::pread_(char* buf, std::uint64_t length, std::uint64_t offset, std::uint64_t max_length) const
+{
+    std::uint64_t done = 0;
+    while (done < length) {
+        const auto r = ::pread(fd_, buf + done, max_length - done, offset + done);
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_io_error(fmt::format("read {} failed", path_));
+        }
+        if (r == 0) {
+            throw data_corrupted{ fmt::format("unexpected eof when reading {}", path_) };
+        }
+
+        done += r;
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "core.h"
+
+namespace cloudkv {
+
+enum class access_hint {
+    normal,
+    random,
+    sequential
+};
+
+// thread safe, positional reads never share a file offset
+class random_access_file : private noncopyable {
+public:
+    // if use_mmap, the whole file is mapped and reads copy nothing
+    // if use_direct_io, reads bypass page cache and mmap is ignored, unless the file system refuses O_DIRECT
+    explicit random_access_file(const path_t& p, bool use_mmap = false, access_hint hint = access_hint::normal, bool use_direct_io = false);
+
+    ~random_access_file();
+
+    // the result points to either the mapped file or scratch, and keeps valid as long as both live
+    std::string_view read(std::uint64_t offset, std::uint64_t length, std::string* scratch) const;
+
+    // throw data_corrupted if out of the file
+    void check_range(std::uint64_t offset, std::uint64_t length) const;
+
+    // hint the kernel to read the range into page cache in background
+    void will_need(std::uint64_t offset, std::uint64_t length) const;
+
+    bool is_mmaped() const
+    {
+        return mapped_ != nullptr;
+    }
+
+    // reads of fd() must be aligned, see aligned_buffer.h
+    bool is_direct() const
+    {
+        return direct_;
+    }
+
+    std::uint64_t size() const
+    {
+        return size_;
+    }
+
+    const path_t& path() const
+    {
+        return path_;
+    }
+
+    int fd() const
+    {
+        return fd_;
+    }
+
+private:
+    // at least length bytes into buf, at most max_length
+    void pread_(char* buf, std::uint64_t length, std::uint64_t offset, std::uint64_t max_length) const;
+
+private:
+    const path_t path_;
+    int fd_ = -1;
+    std::uint64_t size_ = 0;
+    const char* mapped_ = nullptr;
+    bool direct_ = false;
+};
+
+}
@@ -0,0 +1,54 @@
+#include <algorithm>
+#include "util/readahead_buffer.h"
+
+using namespace cloudkv;
+
+namespace {
+
+// blocks are 32KB by default, start with a few of them
+constexpr std::uint64_t initial_readahead = 128 * 1024;
+
+}
+
+readahead_buffer::readahead_buffer(std::uint64_t max_readahead)
+    : max_readahead_(max_readahead),
+      readahead_(std::min(initial_readahead, max_readahead))
+{
+}
+
+std::string_view readahead_buffer::read(const random_access_file& file, std::uint64_t offset, std::uint64_t length, std::string* scratch)
+{
+    sequential_reads_ = offset == last_end_? sequential_reads_ + 1: 0;
+    last_end_ = offset + length;
+
+    if (offset >= buf_offset_ && offset + length <= buf_offset_ + buf_.size()) {
+        return std::string_view(buf_).substr(offset - buf_offset_, length);
+    }
+    if (readahead() == 0) {
+        return file.read(offset, length, scratch);
+    }
+
+    const auto chunk = std::max(readahead_, length);
+    readahead_ = std::min(readahead_ * 2, max_readahead_);
+    if (file.is_mmaped()) {
+        hint_(file, offset + length);
+        return file.read(offset, length, scratch);
+    }
+
+    file.check_range(offset, length);
+    file.read(offset, std::min(chunk, file.size() - offset), &buf_);
+    buf_offset_ = offset;
+    hint_(file, offset + buf_.size());
+
+    return std::string_view(buf_).substr(0, length);
+}
+
+void readahead_buffer::hint_(const random_access_file& file, std::uint64_t offset)
+{
+    const auto begin = std::max(offset, hinted_end_);
+    const auto end = std::min(offset + readahead_, file.size());
+    if (begin < end) {
+        file.will_need(begin, end - begin);
+        hinted_end_ = end;
+    }
+}
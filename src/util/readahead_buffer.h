@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "core.h"
+#include "util/random_access_file.h"
+
+namespace cloudkv {
+
+/**
+ * @brief reads ahead of a file once its reads turn sequential
+ *
+ * following reads are served from chunks read at once, whose size doubles up to max_readahead,
+ * and the chunk after the current one is hinted to the kernel, so it is read in background
+ * while the current one is consumed. reads of mapped files are only hinted.
+ *
+ * not thread safe
+ */
+class readahead_buffer : private noncopyable {
+public:
+    explicit readahead_buffer(std::uint64_t max_readahead);
+
+    // as file.read, but the result may point to the buffer, which keeps valid until the next read
+    std::string_view read(const random_access_file& file, std::uint64_t offset, std::uint64_t length, std::string* scratch);
+
+    // size of the next chunk, 0 until reads turn sequential
+    std::uint64_t readahead() const
+    {
+        return sequential_reads_ >= min_sequential_reads? readahead_: 0;
+    }
+
+private:
+    void hint_(const random_access_file& file, std::uint64_t offset);
+
+private:
+    // sequential reads seen before reading ahead, so random reads never pay for it
+    static constexpr std::uint32_t min_sequential_reads = 2;
+
+    const std::uint64_t max_readahead_;
+    std::uint64_t readahead_;
+
+    std::uint32_t sequential_reads_ = 0;
+    std::uint64_t last_end_ = 0;
+
+    std::uint64_t buf_offset_ = 0;
+    std::string buf_;
+    std::uint64_t hinted_end_ = 0;
+};
+
+}
@@ -0,0 +1,79 @@
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "cloudkv/exception.h"
+#include "util/async_io.h"
+#include "test_util.h"
+
+using namespace cloudkv;
+
+namespace {
+
+std::string make_data(std::size_t size)
+{
+    std::string data(size, '\0');
+    for (std::size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<char>(i * 131 + i / 256);
+    }
+
+    return data;
+}
+
+}
+
+TEST(async_io, Read)
+{
+    ScopedTmpDir dir { __func__ };
+
+    // the last page is cut by eof
+    const auto data = make_data(1024 * 1024 + 123);
+    create_file(dir.path / "1", data);
+
+    for (const bool prefer_io_uring: { true, false }) {
+        for (const std::uint32_t queue_depth: { 1, 4, 32 }) {
+            auto io = make_async_io(queue_depth, prefer_io_uring);
+            if (!prefer_io_uring) {
+                ASSERT_EQ(io->name(), "pread");
+            }
+
+            for (const auto& [use_mmap, use_direct_io]: { std::pair{ false, false }, { true, false }, { false, true } }) {
+                random_access_file file(dir.path / "1", use_mmap, access_hint::normal, use_direct_io);
+
+                // more reads than the queue holds
+                std::vector<std::string> bufs(101);
+                std::vector<read_request> reads;
+                for (std::size_t i = 0; i + 1 < bufs.size(); ++i) {
+                    reads.push_back({ &file, i * 9973, i * 97, &bufs[i] });
+                }
+                reads.push_back({ &file, data.size() - 5000, 5000, &bufs.back() });
+
+                io->read(reads);
+                for (std::size_t i = 0; i + 1 < reads.size(); ++i) {
+                    ASSERT_EQ(reads[i].result, std::string_view(data).substr(i * 9973, i * 97)) << io->name() << i;
+                }
+                ASSERT_EQ(reads.back().result, std::string_view(data).substr(data.size() - 5000));
+            }
+        }
+    }
+}
+
+TEST(async_io, OutOfRange)
+{
+    ScopedTmpDir dir { __func__ };
+
+    create_file(dir.path / "1", make_data(4096));
+    random_access_file file(dir.path / "1");
+
+    for (const bool prefer_io_uring: { true, false }) {
+        auto io = make_async_io(4, prefer_io_uring);
+
+        std::string buf1, buf2;
+        std::vector<read_request> reads{ { &file, 0, 4096, &buf1 }, { &file, 4000, 100, &buf2 } };
+        ASSERT_THROW(io->read(reads), data_corrupted);
+
+        // the engine keeps usable
+        std::vector<read_request> ok{ { &file, 0, 4096, &buf1 } };
+        io->read(ok);
+        ASSERT_EQ(ok[0].result.size(), 4096);
+    }
+}
@@ -0,0 +1,93 @@
+#include <fstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "blob/blob_file.h"
+#include "blob/blob_store.h"
+#include "cloudkv/exception.h"
+#include "test_util.h"
+
+using namespace cloudkv;
+
+TEST(blob_file, Ref)
+{
+    const blob_ref ref{ 42, 1ull << 40, 1234 };
+
+    std::string buf;
+    ref.encode_to(&buf);
+    ASSERT_EQ(buf.size(), blob_ref::encoded_size);
+
+    const auto decoded = blob_ref::decode(buf);
+    ASSERT_EQ(decoded.file_id, ref.file_id);
+    ASSERT_EQ(decoded.offset, ref.offset);
+    ASSERT_EQ(decoded.size, ref.size);
+
+    EXPECT_THROW(blob_ref::decode(std::string_view(buf).substr(1)), data_corrupted);
+}
+
+TEST(blob_file, ReadWrite)
+{
+    ScopedTmpDir dir("blob_file");
+    const path_conf db_path(dir.path);
+    fs::create_directory(db_path.blob_dir());
+
+    for (const bool direct: { false, true }) {
+        options opts;
+        opts.use_direct_io = direct;
+
+        blob_file_builder builder(opts, db_path.blob_path(7), 7);
+        std::vector<std::string> values;
+        std::vector<blob_ref> refs;
+        for (int i = 0; i < 100; ++i) {
+            values.push_back(std::string(i * 97, 'a' + i % 26));
+            refs.push_back(builder.add(values.back()));
+        }
+        builder.done();
+
+        std::uint64_t total = 0;
+        for (const auto& v: values) {
+            total += v.size();
+        }
+        ASSERT_EQ(builder.meta().file_id, 7);
+        ASSERT_EQ(builder.meta().total_bytes, total);
+        ASSERT_EQ(builder.meta().discardable_bytes, 0);
+
+        blob_store store(db_path, 16, direct);
+        std::string scratch;
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            ASSERT_EQ(store.get(refs[i], true, &scratch), values[i]) << i;
+        }
+
+        // size in ref mismatches the record
+        auto bad = refs[10];
+        bad.size += 1;
+        EXPECT_THROW(store.get(bad, true, &scratch), data_corrupted);
+
+        // out of file
+        bad = refs.back();
+        bad.offset += 1024 * 1024;
+        EXPECT_THROW(store.get(bad, true, &scratch), data_corrupted);
+    }
+}
+
+TEST(blob_file, Checksum)
+{
+    ScopedTmpDir dir("blob_file");
+    const path_conf db_path(dir.path);
+    fs::create_directory(db_path.blob_dir());
+
+    blob_file_builder builder(options{}, db_path.blob_path(1), 1);
+    const auto ref = builder.add(std::string(1000, 'x'));
+    builder.done();
+
+    {
+        std::fstream f(db_path.blob_path(1), std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(ref.offset + blob_record_header_size + 500);
+        f.put('y');
+    }
+
+    blob_store store(db_path, 16);
+    std::string scratch;
+    EXPECT_THROW(store.get(ref, true, &scratch), data_corrupted);
+    ASSERT_EQ(store.get(ref, false, &scratch).size(), 1000);
+}
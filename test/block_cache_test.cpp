@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "sstable/block_cache.h"
+#include "sstable/block_builder.h"
+#include "sstable/table_cache.h"
+#include "test_util.h"
+
+using namespace std;
+using namespace cloudkv;
+
+namespace {
+
+block_ptr make_block(int count)
+{
+    block_builder builder({});
+
+    for (const auto& [k, v]: make_kv(count)) {
+        builder.add(k, v);
+    }
+
+    return std::make_shared<const block>(builder.done());
+}
+
+}
+
+TEST(block_cache, FindAndInsert)
+{
+    block_cache cache(1024 * 1024);
+
+    ASSERT_FALSE(cache.find(1, 0));
+
+    auto blk = make_block(16);
+    cache.insert(1, 0, blk);
+    ASSERT_EQ(cache.find(1, 0), blk);
+    ASSERT_FALSE(cache.find(1, 1));
+    ASSERT_FALSE(cache.find(2, 0));
+    ASSERT_EQ(cache.bytes_used(), blk->size_in_bytes());
+}
+
+TEST(block_cache, Bounded)
+{
+    const auto blk_size = make_block(16)->size_in_bytes();
+    const std::uint64_t capacity = blk_size * 64;
+    block_cache cache(capacity);
+
+    auto first = make_block(16);
+    cache.insert(1, 0, first);
+
+    for (std::uint64_t i = 1; i < 1024; ++i) {
+        cache.insert(1, i * blk_size, make_block(16));
+        ASSERT_LE(cache.bytes_used(), capacity);
+    }
+
+    // evicted block keeps valid
+    auto it = first->iter();
+    it->seek_first();
+    ASSERT_FALSE(it->is_eof());
+    ASSERT_EQ(it->current().key, make_kv(16).begin()->first);
+}
+
+TEST(block_cache, SharedByReaders)
+{
+    ScopedTmpDir dir { __func__ };
+
+    auto kv = make_kv(4096);
+    auto sst = make_sst(dir.path / "1", kv);
+
+    block_cache blocks(64 * 1024 * 1024);
+    table_cache tables(16, { &blocks });
+
+    auto it1 = sst->iter(tables);
+    for (it1->seek_first(); !it1->is_eof(); it1->next()) {
+    }
+
+    const auto cached = blocks.bytes_used();
+    ASSERT_GT(cached, 0);
+
+    auto it2 = sst->iter(tables);
+    auto kv_iter = kv.begin();
+    for (it2->seek_first(); !it2->is_eof(); it2->next(), ++kv_iter) {
+        ASSERT_TRUE(kv_iter != kv.end());
+
+        const auto [k, v] = it2->current();
+        ASSERT_EQ(k, kv_iter->first);
+        ASSERT_EQ(v, kv_iter->second);
+    }
+    ASSERT_TRUE(kv_iter == kv.end());
+    ASSERT_EQ(blocks.bytes_used(), cached);
+}
@@ -3,7 +3,9 @@
 #include <gtest/gtest.h>
 #include "sstable/block.h"
 #include "sstable/block_builder.h"
+#include "kv_format.h"
 #include "cloudkv/options.h"
+#include "cloudkv/exception.h"
 #include "test_util.h"
 
 using namespace cloudkv;
@@ -92,4 +94,333 @@ TEST(block, Seek)
 
     it->seek("8");
     ASSERT_TRUE(it->is_eof());
-}
\ No newline at end of file
+}
+
+TEST(block, RestartPoints)
+{
+    std::map<std::string, std::string> kv;
+    for (int i = 0; i < 1000; ++i) {
+        kv.emplace(fmt::format("key-{:06}", i * 2), fmt::format("value-{}", i));
+    }
+
+    for (const std::uint32_t interval: { 1, 2, 16, 2000 }) {
+        block_builder builder({}, interval);
+        for (const auto& [k, v]: kv) {
+            builder.add(k, v);
+        }
+
+        block blk(builder.done());
+        ASSERT_EQ(blk.count(), kv.size());
+
+        auto it = blk.iter();
+        auto kv_iter = kv.begin();
+        for (it->seek_first(); !it->is_eof(); it->next(), ++kv_iter) {
+            ASSERT_TRUE(kv_iter != kv.end());
+            ASSERT_EQ(it->current().key, kv_iter->first);
+            ASSERT_EQ(it->current().value, kv_iter->second);
+        }
+        ASSERT_TRUE(kv_iter == kv.end());
+
+        std::string scratch;
+        for (int i = 0; i < 2000; ++i) {
+            const auto key = fmt::format("key-{:06}", i);
+            const auto expected = kv.lower_bound(key);
+
+            it->seek(key);
+            const auto r = blk.lower_bound(key, &scratch);
+            if (expected == kv.end()) {
+                ASSERT_TRUE(it->is_eof());
+                ASSERT_FALSE(r);
+                continue;
+            }
+
+            ASSERT_FALSE(it->is_eof());
+            ASSERT_EQ(it->current().key, expected->first);
+            ASSERT_TRUE(r);
+            ASSERT_EQ(r->key, expected->first);
+            ASSERT_EQ(r->value, expected->second);
+        }
+
+        it->seek("a");
+        ASSERT_FALSE(it->is_eof());
+        ASSERT_EQ(it->current().key, kv.begin()->first);
+    }
+}
+
+TEST(block, PrefixCompressed)
+{
+    std::map<std::string, std::string> kv;
+    for (int i = 0; i < 256; ++i) {
+        kv.emplace(fmt::format("a-long-shared-prefix-for-all-keys-{:06}", i), "v");
+    }
+
+    block_builder flat({}, 16, sst::block_format::flat);
+    block_builder prefix({}, 16);
+    for (const auto& [k, v]: kv) {
+        flat.add(k, v);
+        prefix.add(k, v);
+    }
+
+    ASSERT_LT(prefix.done().size() * 2, flat.done().size());
+}
+
+TEST(block, ReadFlatFormat)
+{
+    std::map<std::string, std::string> kv = make_kv(64);
+
+    block_builder builder({}, 16, sst::block_format::flat);
+    for (const auto& [k, v]: kv) {
+        builder.add(k, v);
+    }
+
+    block blk(builder.done());
+    ASSERT_EQ(blk.count(), kv.size());
+
+    auto it = blk.iter();
+    auto kv_iter = kv.begin();
+    for (it->seek_first(); !it->is_eof(); it->next(), ++kv_iter) {
+        ASSERT_EQ(it->current().key, kv_iter->first);
+        ASSERT_EQ(it->current().value, kv_iter->second);
+    }
+    ASSERT_TRUE(kv_iter == kv.end());
+
+    std::string scratch;
+    for (const auto& [k, v]: kv) {
+        const auto r = blk.lower_bound(k, &scratch);
+        ASSERT_TRUE(r);
+        ASSERT_EQ(r->key, k);
+        ASSERT_EQ(r->value, v);
+    }
+}
+
+TEST(block, HashIndex)
+{
+    std::map<std::string, std::string> kv;
+    for (int i = 0; i < 1024; i += 2) {
+        kv.emplace(internal_key(fmt::format("key-{:06}", i), key_type::value).underlying_key(), fmt::format("value-{}", i));
+    }
+
+    for (const auto restart_interval: { 16, 1 }) {
+        // restart per key overflows the hash index, falling back to binary search
+        // key heads go along with the hash index
+        block_builder hashed({}, restart_interval, sst::block_format::prefix_hash, restart_interval > 1);
+        block_builder prefix({}, restart_interval);
+        for (const auto& [k, v]: kv) {
+            hashed.add(k, v);
+            prefix.add(k, v);
+        }
+
+        const std::string buf(hashed.done());
+        if (restart_interval == 1) {
+            ASSERT_EQ(buf.size(), prefix.done().size());
+        } else {
+            ASSERT_GT(buf.size(), prefix.done().size());
+        }
+
+        block blk(buf);
+        ASSERT_EQ(blk.count(), kv.size());
+
+        std::string scratch;
+        for (const auto& [k, v]: kv) {
+            const auto r = blk.get(extract_user_key(k), &scratch);
+            ASSERT_TRUE(r);
+            ASSERT_EQ(r->key, k);
+            ASSERT_EQ(r->value, v);
+        }
+        for (int i = 1; i < 1024; i += 2) {
+            ASSERT_FALSE(blk.get(fmt::format("key-{:06}", i), &scratch));
+        }
+        ASSERT_FALSE(blk.get("", &scratch));
+        ASSERT_FALSE(blk.get("key-999999", &scratch));
+
+        // iterators ignore the hash index
+        auto it = blk.iter();
+        auto kv_iter = kv.begin();
+        for (it->seek_first(); !it->is_eof(); it->next(), ++kv_iter) {
+            ASSERT_EQ(it->current().key, kv_iter->first);
+        }
+        ASSERT_TRUE(kv_iter == kv.end());
+    }
+}
+
+TEST(block, KeyHeads)
+{
+    std::map<std::string, std::string> kv;
+    for (int i = 0; i < 512; ++i) {
+        // heads tie on keys differing after 8 bytes following the shared prefix, or only in length
+        kv.emplace(fmt::format("prefix-{:03}-same-head-{:03}", i / 4, i), "v");
+        kv.emplace(fmt::format("prefix-{:03}", i / 4), "v");
+    }
+
+    for (const auto restart_interval: { 16, 1 }) {
+        block_builder heads({}, restart_interval, sst::block_format::prefix, true);
+        block_builder prefix({}, restart_interval);
+        for (const auto& [k, v]: kv) {
+            heads.add(k, v);
+            prefix.add(k, v);
+        }
+
+        const std::string buf(heads.done());
+        ASSERT_GT(buf.size(), prefix.done().size());
+
+        block blk(buf);
+        ASSERT_EQ(blk.count(), kv.size());
+
+        auto it = blk.iter();
+        std::string scratch;
+        for (const auto& key: { "a", "prefix-", "prefix-000", "prefix-000-", "prefix-064-same-head-256", "prefix-064-same-head-2560", "prefix-127-z", "prefix-128", "z" }) {
+            const auto expected = kv.lower_bound(key);
+
+            it->seek(key);
+            const auto r = blk.lower_bound(key, &scratch);
+            if (expected == kv.end()) {
+                ASSERT_TRUE(it->is_eof()) << key;
+                ASSERT_FALSE(r) << key;
+                continue;
+            }
+
+            ASSERT_FALSE(it->is_eof()) << key;
+            ASSERT_EQ(it->current().key, expected->first);
+            ASSERT_TRUE(r) << key;
+            ASSERT_EQ(r->key, expected->first);
+        }
+
+        for (const auto& [k, v]: kv) {
+            it->seek(k);
+            ASSERT_FALSE(it->is_eof());
+            ASSERT_EQ(it->current().key, k);
+        }
+    }
+
+    // the flag is only valid on prefix blocks
+    std::string buf;
+    PutFixed32(&buf, (sst::block_key_heads_flag << 24));
+    ASSERT_THROW(block{ buf }, data_corrupted);
+}
+
+TEST(block, LowerBoundWindow)
+{
+    std::map<std::string, std::string> kv;
+    for (int i = 0; i < 256; ++i) {
+        kv.emplace(fmt::format("key-{:06}", i * 2), "v");
+    }
+
+    for (const auto restart_interval: { 1, 4 }) {
+        block_builder builder({}, restart_interval);
+        block_builder flat({}, restart_interval, sst::block_format::flat);
+        for (const auto& [k, v]: kv) {
+            builder.add(k, v);
+            flat.add(k, v);
+        }
+
+        const std::string buf(builder.done());
+        const std::string flat_buf(flat.done());
+        for (const auto& content: { buf, flat_buf }) {
+            block blk(content);
+            std::string scratch;
+
+            // windows missing the result fall back to the whole block
+            const std::uint32_t restart_count = (kv.size() + restart_interval - 1) / restart_interval;
+            for (int i = 0; i < 513; ++i) {
+                const auto key = fmt::format("key-{:06}", i);
+                const auto expected = kv.lower_bound(key);
+                for (const std::uint32_t first: { 0u, 10u, restart_count / 2, restart_count + 1 }) {
+                    const auto r = blk.lower_bound(key, &scratch, first, first + 3);
+                    if (expected == kv.end()) {
+                        ASSERT_FALSE(r);
+                    } else {
+                        ASSERT_TRUE(r) << key;
+                        ASSERT_EQ(r->key, expected->first);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(block, Reverse)
+{
+    std::map<std::string, std::string> kv;
+    for (int i = 0; i < 1000; i += 2) {
+        kv.emplace(internal_key(fmt::format("key-{:06}", i), key_type::value).underlying_key(), fmt::format("value-{}", i));
+    }
+
+    for (const auto format: { sst::block_format::flat, sst::block_format::prefix }) {
+        for (const std::uint32_t interval: { 1, 16, 2000 }) {
+            block_builder builder({}, interval, format);
+            for (const auto& [k, v]: kv) {
+                builder.add(k, v);
+            }
+
+            block blk(builder.done());
+            auto it = blk.iter();
+
+            auto kv_iter = kv.rbegin();
+            for (it->seek_last(); !it->is_eof(); it->prev(), ++kv_iter) {
+                ASSERT_TRUE(kv_iter != kv.rend());
+                ASSERT_EQ(it->current().key, kv_iter->first);
+                ASSERT_EQ(it->current().value, kv_iter->second);
+            }
+            ASSERT_TRUE(kv_iter == kv.rend());
+
+            for (int i = 0; i < 1001; ++i) {
+                const auto key = fmt::format("key-{:06}", i);
+                it->seek_for_prev(key);
+                if (i == 0) {
+                    ASSERT_EQ(extract_user_key(it->current().key), key);
+                    continue;
+                }
+
+                ASSERT_FALSE(it->is_eof());
+                ASSERT_EQ(extract_user_key(it->current().key), fmt::format("key-{:06}", std::min(i - i % 2, 998)));
+
+                // switch direction in place
+                it->next();
+                if (i < 998) {
+                    ASSERT_EQ(extract_user_key(it->current().key), fmt::format("key-{:06}", i - i % 2 + 2));
+                    it->prev();
+                    ASSERT_EQ(extract_user_key(it->current().key), fmt::format("key-{:06}", i - i % 2));
+                }
+            }
+
+            it->seek_for_prev("a");
+            ASSERT_TRUE(it->is_eof());
+            it->seek_first();
+            it->prev();
+            ASSERT_TRUE(it->is_eof());
+        }
+    }
+}
+
+TEST(block, Empty)
+{
+    block_builder builder({});
+
+    block blk(builder.done());
+    ASSERT_EQ(blk.count(), 0);
+
+    auto it = blk.iter();
+    it->seek_first();
+    ASSERT_TRUE(it->is_eof());
+    it->seek("a");
+    ASSERT_TRUE(it->is_eof());
+    it->seek_last();
+    ASSERT_TRUE(it->is_eof());
+    it->seek_for_prev("a");
+    ASSERT_TRUE(it->is_eof());
+
+    std::string scratch;
+    ASSERT_FALSE(blk.lower_bound("a", &scratch));
+}
+
+TEST(block, Corrupted)
+{
+    std::string buf;
+    PutFixed32(&buf, 0xff000000);
+    ASSERT_THROW(block{ buf }, data_corrupted);
+
+    buf.clear();
+    PutFixed32(&buf, 1);
+    PutFixed32(&buf, (1u << 24) | 100);
+    ASSERT_THROW(block{ buf }, data_corrupted);
+}
@@ -0,0 +1,51 @@
+#include <string>
+#include <gtest/gtest.h>
+#include "sstable/bloom_filter.h"
+
+using namespace cloudkv;
+
+TEST(bloom_filter, Empty)
+{
+    bloom_filter filter;
+    ASSERT_TRUE(filter.may_contain("hello"));
+    ASSERT_TRUE(filter.may_contain(""));
+}
+
+TEST(bloom_filter, NoFalseNegative)
+{
+    for (const int count: { 1, 10, 100, 1000, 10000 }) {
+        bloom_filter_builder builder(10);
+        for (int i = 0; i < count; ++i) {
+            builder.add("key-" + std::to_string(i));
+        }
+
+        bloom_filter filter(builder.done());
+        ASSERT_GT(filter.size_in_bytes(), 0);
+        ASSERT_TRUE(builder.empty());
+
+        for (int i = 0; i < count; ++i) {
+            ASSERT_TRUE(filter.may_contain("key-" + std::to_string(i)));
+        }
+    }
+}
+
+TEST(bloom_filter, FalsePositiveRate)
+{
+    const int count = 10000;
+    bloom_filter_builder builder(10);
+    for (int i = 0; i < count; ++i) {
+        builder.add(std::to_string(i));
+    }
+
+    bloom_filter filter(builder.done());
+
+    int false_positives = 0;
+    for (int i = count; i < count * 2; ++i) {
+        if (filter.may_contain(std::to_string(i))) {
+            ++false_positives;
+        }
+    }
+
+    // ~1% expected for 10 bits per key
+    ASSERT_LT(false_positives, count * 2 / 100);
+}
@@ -3,6 +3,7 @@
 #include <range/v3/view.hpp>
 #include <range/v3/action.hpp>
 #include "task/checkpoint_task.h"
+#include "blob/blob_store.h"
 #include "memtable/memtable.h"
 #include "sstable/sstable.h"
 #include "util/fmt_std.h"
@@ -39,7 +40,7 @@ TEST(checkpoint_task, OneFile)
     }
 
     sstable_ptr sst;
-    checkpoint_task({db_path, id_alloc, gc, mt, [&sst](sstable_ptr s){
+    checkpoint_task({db_path, options{}, id_alloc, gc, mt, [&sst](sstable_ptr s, const auto&){
         sst = std::move(s);
     }}).run();
 
@@ -58,4 +59,44 @@ TEST(checkpoint_task, OneFile)
     }
 
     ASSERT_TRUE(kv_it == kv.end());
-}
\ No newline at end of file
+}
+
+TEST(checkpoint_task, BlobFile)
+{
+    auto db_root = fs::temp_directory_path() / test_db;
+    DBCleaner _(db_root);
+
+    path_conf db_path(db_root);
+    fs::create_directories(db_path.sst_dir());
+    fs::create_directories(db_path.blob_dir());
+
+    options opts;
+    opts.min_blob_size = 100;
+
+    auto mt = std::make_shared<memtable>();
+    mt->add(key_type::value, "k1", "small");
+    mt->add(key_type::value, "k2", std::string(100, 'x'));
+    mt->add(key_type::tombsome, "k3", "");
+
+    sstable_ptr sst;
+    std::vector<blob_file_meta> blobs;
+    checkpoint_task({db_path, opts, id_alloc, gc, mt, [&](sstable_ptr s, const auto& b){
+        sst = std::move(s);
+        blobs = b;
+    }}).run();
+
+    ASSERT_EQ(blobs.size(), 1);
+    ASSERT_EQ(blobs[0].total_bytes, 100);
+    ASSERT_EQ(sst->blob_files(), std::vector<std::uint64_t>{ blobs[0].file_id });
+
+    const auto kvs = dump_all(sst->iter());
+    ASSERT_EQ(kvs.size(), 3);
+    ASSERT_TRUE(kvs[0].key.is_value());
+    ASSERT_EQ(kvs[0].value, "small");
+    ASSERT_TRUE(kvs[1].key.is_blob_index());
+    ASSERT_TRUE(kvs[2].key.is_deleted());
+
+    blob_store store(db_path, 16);
+    std::string scratch;
+    ASSERT_EQ(store.get(blob_ref::decode(kvs[1].value), true, &scratch), std::string(100, 'x'));
+}
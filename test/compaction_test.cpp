@@ -3,6 +3,8 @@
 #include <range/v3/view.hpp>
 #include <range/v3/action.hpp>
 #include "task/compaction_task.h"
+#include "task/checkpoint_task.h"
+#include "memtable/memtable.h"
 #include "sstable/sstable.h"
 #include "sstable/sstable_builder.h"
 #include "util/fmt_std.h"
@@ -31,7 +33,7 @@ TEST(compaction_task, Empty)
     fs::create_directories(db_path.sst_dir());
 
     std::vector<sstable_ptr> sstables;
-    compaction_task({ db_path, options{}, id_alloc, gc, sstables, [](const auto& adds, const auto& dels){
+    compaction_task({ db_path, options{}, id_alloc, gc, sstables, [](const auto& adds, const auto& dels, const auto&){
         EXPECT_TRUE(adds.empty());
         EXPECT_TRUE(dels.empty());
     }}).run();
@@ -48,7 +50,7 @@ TEST(compaction_task, OneFile)
     std::vector<sstable_ptr> added;
     std::vector<sstable_ptr> removed;
     std::vector<sstable_ptr> sstables { make_sst_in_kv_format(db_path.sst_path(id_alloc.alloc())) };
-    compaction_task({db_path, options{}, id_alloc, gc, sstables, [&](const auto& adds, const auto& dels){
+    compaction_task({db_path, options{}, id_alloc, gc, sstables, [&](const auto& adds, const auto& dels, const auto&){
         added = adds;
         removed = dels;
     }}).run();
@@ -87,7 +89,7 @@ TEST(compaction_task, NotOverlapFile)
         make_sst_in_kv_format(db_path.sst_path(id_alloc.alloc()), 20),
         make_sst_in_kv_format(db_path.sst_path(id_alloc.alloc()), 30)
     };
-    compaction_task({db_path, options{}, id_alloc, gc, sstables, [&](const auto& adds, const auto& dels){
+    compaction_task({db_path, options{}, id_alloc, gc, sstables, [&](const auto& adds, const auto& dels, const auto&){
         added = adds;
         removed = dels;
     }}).run();
@@ -132,7 +134,7 @@ TEST(compaction_task, OverlappedFile)
         make_sst_in_kv_format(db_path.sst_path(4), 60, kv_count / 10)
     };
     file_id_allocator id_alloc{ 5 };
-    compaction_task({db_path, options{}, id_alloc, gc, sstables, [&](const auto& adds, const auto& dels){
+    compaction_task({db_path, options{}, id_alloc, gc, sstables, [&](const auto& adds, const auto& dels, const auto&){
         added = adds;
         removed = dels;
     }}).run();
@@ -156,4 +158,72 @@ TEST(compaction_task, OverlappedFile)
         ASSERT_TRUE(value_in_sst);
         EXPECT_EQ(value_in_sst.value().value, v);
     }
-}
\ No newline at end of file
+}
+TEST(compaction_task, BlobFiles)
+{
+    auto db_root = fs::temp_directory_path() / test_db;
+    DBCleaner _(db_root);
+
+    path_conf db_path(db_root);
+    fs::create_directories(db_path.sst_dir());
+    fs::create_directories(db_path.blob_dir());
+
+    options opts;
+    opts.min_blob_size = 100;
+
+    auto checkpoint = [&](char fill, int count) {
+        auto mt = std::make_shared<memtable>();
+        for (int i = 0; i < count; ++i) {
+            mt->add(key_type::value, fmt::format("key-{:03}", i), std::string(200, fill));
+        }
+        mt->add(key_type::value, "small", std::string(1, fill));
+
+        std::pair<sstable_ptr, blob_file_meta> res;
+        checkpoint_task({db_path, opts, id_alloc, gc, mt, [&](sstable_ptr sst, const auto& blobs){
+            res = { sst, blobs.at(0) };
+        }}).run();
+        return res;
+    };
+
+    // half of the old values are overwritten
+    const auto [old_sst, old_blob] = checkpoint('a', 10);
+    const auto [new_sst, new_blob] = checkpoint('b', 5);
+
+    std::vector<sstable_ptr> added;
+    std::map<std::uint64_t, blob_file_meta> blob_files;
+    blob_store blobs(db_path, 16);
+    std::vector<blob_file_meta> blob_meta {
+        { old_blob.file_id, old_blob.total_bytes, old_blob.total_bytes / 2 },
+        new_blob
+    };
+    compaction_task({db_path, opts, id_alloc, gc, { old_sst, new_sst }, [&](const auto& adds, const auto&, const auto& b){
+        added = adds;
+        for (const auto& x: b) {
+            blob_files[x.file_id] = x;
+        }
+    }, &blobs, blob_meta}).run();
+
+    // the old one is rewritten, so all discardable, the new one is referred to as is
+    ASSERT_EQ(added.size(), 1);
+    ASSERT_EQ(blob_files.size(), 3);
+    ASSERT_EQ(blob_files[old_blob.file_id].discardable_bytes, old_blob.total_bytes);
+    ASSERT_EQ(blob_files[new_blob.file_id].discardable_bytes, 0);
+    ASSERT_EQ(blob_files[new_blob.file_id].total_bytes, new_blob.total_bytes);
+
+    const auto rewritten = blob_files.rbegin()->second;
+    ASSERT_GT(rewritten.file_id, new_blob.file_id);
+    ASSERT_EQ(rewritten.total_bytes, 5 * 200);
+    ASSERT_EQ(rewritten.discardable_bytes, 0);
+    ASSERT_EQ(added[0]->blob_files(), (std::vector<std::uint64_t>{ new_blob.file_id, rewritten.file_id }));
+
+    std::string scratch;
+    const auto kvs = dump_all(added[0]->iter());
+    ASSERT_EQ(kvs.size(), 11);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(kvs[i].key.is_blob_index());
+        const auto ref = blob_ref::decode(kvs[i].value);
+        ASSERT_EQ(ref.file_id, i < 5? new_blob.file_id: rewritten.file_id);
+        ASSERT_EQ(blobs.get(ref, true, &scratch), std::string(200, i < 5? 'b': 'a'));
+    }
+    ASSERT_EQ(kvs[10].value, "b");
+}
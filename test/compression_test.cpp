@@ -0,0 +1,53 @@
+#include <random>
+#include <string>
+#include <gtest/gtest.h>
+#include "cloudkv/exception.h"
+#include "util/compression.h"
+
+using namespace cloudkv;
+
+TEST(compression, RoundTrip)
+{
+    std::string compressible;
+    for (int i = 0; i < 1024; ++i) {
+        compressible += "value-" + std::to_string(i % 16) + std::string(32, ' ');
+    }
+
+    for (const auto type: { compression_type::none, compression_type::lz4, compression_type::zstd }) {
+        std::string compressed;
+        compress(type, compressible, &compressed);
+        if (type != compression_type::none) {
+            ASSERT_LT(compressed.size() * 4, compressible.size());
+        }
+
+        std::string raw;
+        uncompress(type, compressed, &raw);
+        ASSERT_EQ(raw, compressible);
+
+        compressed.clear();
+        compress(type, "", &compressed);
+        uncompress(type, compressed, &raw);
+        ASSERT_TRUE(raw.empty());
+    }
+}
+
+TEST(compression, Corrupted)
+{
+    std::mt19937 engine(1);
+    std::string input(4096, '\0');
+    for (auto& c: input) {
+        c = static_cast<char>(engine() % 4);
+    }
+
+    for (const auto type: { compression_type::lz4, compression_type::zstd }) {
+        std::string compressed;
+        compress(type, input, &compressed);
+
+        std::string raw;
+        ASSERT_THROW(uncompress(type, compressed.substr(0, compressed.size() / 2), &raw), data_corrupted);
+        ASSERT_THROW(uncompress(type, "", &raw), data_corrupted);
+    }
+
+    std::string raw;
+    ASSERT_THROW(uncompress(static_cast<compression_type>(100), "\x01x", &raw), data_corrupted);
+}
@@ -0,0 +1,60 @@
+#include <random>
+#include <string>
+#include <gtest/gtest.h>
+#include "util/crc32c.h"
+
+using namespace cloudkv;
+
+TEST(crc32c, StandardResults)
+{
+    // from rfc3720 section b.4
+    std::string buf(32, '\0');
+    ASSERT_EQ(crc32c::value(buf), 0x8a9136aa);
+
+    buf.assign(32, '\xff');
+    ASSERT_EQ(crc32c::value(buf), 0x62a8ab43);
+
+    for (int i = 0; i < 32; ++i) {
+        buf[i] = i;
+    }
+    ASSERT_EQ(crc32c::value(buf), 0x46dd794e);
+
+    for (int i = 0; i < 32; ++i) {
+        buf[i] = 31 - i;
+    }
+    ASSERT_EQ(crc32c::value(buf), 0x113fdb5c);
+}
+
+TEST(crc32c, Extend)
+{
+    ASSERT_EQ(crc32c::value("hello world"), crc32c::extend(crc32c::value("hello "), "world", 5));
+    ASSERT_NE(crc32c::value("a"), crc32c::value("foo"));
+}
+
+TEST(crc32c, PortableMatchesHardware)
+{
+    std::mt19937 engine(1);
+    std::string buf(4096 + 7, '\0');
+    for (auto& c: buf) {
+        c = static_cast<char>(engine());
+    }
+
+    // all alignments and tails
+    for (std::size_t offset = 0; offset < 8; ++offset) {
+        for (std::size_t len = 0; len < 64; ++len) {
+            ASSERT_EQ(crc32c::extend(0, buf.data() + offset, len), crc32c::extend_portable(0, buf.data() + offset, len));
+        }
+
+        const auto len = buf.size() - offset;
+        ASSERT_EQ(crc32c::extend(7, buf.data() + offset, len), crc32c::extend_portable(7, buf.data() + offset, len));
+    }
+}
+
+TEST(crc32c, Mask)
+{
+    const auto crc = crc32c::value("foo");
+    ASSERT_NE(crc, crc32c::mask(crc));
+    ASSERT_NE(crc, crc32c::mask(crc32c::mask(crc)));
+    ASSERT_EQ(crc, crc32c::unmask(crc32c::mask(crc)));
+    ASSERT_EQ(crc, crc32c::unmask(crc32c::unmask(crc32c::mask(crc32c::mask(crc)))));
+}
@@ -5,6 +5,7 @@
 #include <range/v3/action.hpp>
 #include <range/v3/algorithm.hpp>
 #include <gtest/gtest.h>
+#include <fmt/core.h>
 #include "cloudkv/exception.h"
 #include "db_impl.h"
 #include "test_util.h"
@@ -140,6 +141,119 @@ TEST(db, QueryRange)
     ASSERT_TRUE(test_it == testkv.end());
 }
 
+TEST(db, ReverseIteration)
+{
+    Cleanup _;
+
+    options opts;
+    opts.write_buffer_size = 4096;
+    auto db = open(db_name, opts);
+
+    // versions spread over sstables and memtables
+    std::map<std::string, std::string> testkv;
+    for (int round = 0; round < 3; ++round) {
+        for (int i = round; i < 512; i += round + 1) {
+            const auto key = fmt::format("key-{:04}", i);
+            if (i % 7 == round) {
+                db->remove(key);
+                testkv.erase(key);
+            } else {
+                const auto value = fmt::format("value-{}-{}", i, round);
+                db->add(key, value);
+                testkv[key] = value;
+            }
+        }
+    }
+
+    auto it = db->iter();
+    auto test_it = testkv.rbegin();
+    for (it->seek_last(); !it->is_eof(); it->prev(), ++test_it) {
+        ASSERT_TRUE(test_it != testkv.rend());
+        ASSERT_EQ(it->current().key, test_it->first);
+        ASSERT_EQ(it->current().value, test_it->second);
+    }
+    ASSERT_TRUE(test_it == testkv.rend());
+
+    for (int i = 0; i < 520; i += 3) {
+        const auto key = fmt::format("key-{:04}", i);
+        auto expected = testkv.upper_bound(key);
+
+        it->seek_for_prev(key);
+        if (expected == testkv.begin()) {
+            ASSERT_TRUE(it->is_eof());
+            continue;
+        }
+
+        --expected;
+        ASSERT_FALSE(it->is_eof());
+        ASSERT_EQ(it->current().key, expected->first);
+        ASSERT_EQ(it->current().value, expected->second);
+
+        // back and forth
+        it->next();
+        if (++expected == testkv.end()) {
+            ASSERT_TRUE(it->is_eof());
+            continue;
+        }
+        ASSERT_EQ(it->current().key, expected->first);
+        it->prev();
+        ASSERT_EQ(it->current().value, (--expected)->second);
+    }
+}
+
+TEST(db, IterBounds)
+{
+    Cleanup _;
+
+    options opts;
+    opts.write_buffer_size = 4096;
+    auto db = open(db_name, opts);
+
+    std::map<std::string, std::string> testkv;
+    for (int i = 0; i < 1024; ++i) {
+        const auto key = fmt::format("key-{:04}", i);
+        db->add(key, key);
+        testkv.emplace(key, key);
+    }
+    for (int i = 0; i < 1024; i += 5) {
+        const auto key = fmt::format("key-{:04}", i);
+        db->remove(key);
+        testkv.erase(key);
+    }
+
+    read_options ropts;
+    ropts.lower_bound = "key-0300";
+    ropts.upper_bound = "key-0600";
+
+    const auto first = testkv.lower_bound(ropts.lower_bound);
+    const auto last = testkv.lower_bound(ropts.upper_bound);
+
+    auto it = db->iter(ropts);
+    auto test_it = first;
+    for (it->seek_first(); !it->is_eof(); it->next(), ++test_it) {
+        ASSERT_TRUE(test_it != last);
+        ASSERT_EQ(it->current().key, test_it->first);
+    }
+    ASSERT_TRUE(test_it == last);
+
+    auto rtest_it = std::make_reverse_iterator(last);
+    for (it->seek_last(); !it->is_eof(); it->prev(), ++rtest_it) {
+        ASSERT_TRUE(rtest_it != std::make_reverse_iterator(first));
+        ASSERT_EQ(it->current().key, rtest_it->first);
+    }
+    ASSERT_TRUE(rtest_it == std::make_reverse_iterator(first));
+
+    // seeks are clamped into the bounds
+    it->seek("key-0100");
+    ASSERT_EQ(it->current().key, first->first);
+    it->seek_for_prev("key-0900");
+    ASSERT_EQ(it->current().key, std::prev(last)->first);
+    it->seek("key-0700");
+    ASSERT_TRUE(it->is_eof());
+    it->seek_for_prev("key-0200");
+    ASSERT_TRUE(it->is_eof());
+}
+
 TEST(db, Checkpoint)
 {
     Cleanup _;
@@ -188,3 +302,230 @@ TEST(db, Persistent)
         ASSERT_EQ(r.value(), "val-" + std::to_string(i));
     }
 }
+
+TEST(db, MultiQuery)
+{
+    for (const std::uint32_t io_queue_depth: { 0, 8 }) {
+        Cleanup _;
+
+        options opts;
+        opts.write_buffer_size = 1024;
+        opts.io_queue_depth = io_queue_depth;
+        auto db = open(db_name, opts);
+
+        // spread over several sstables, with newer values and deletions on top
+        for (auto i: indices(1024)) {
+            db->add("key-" + std::to_string(i), "val-" + std::to_string(i));
+        }
+        for (int i = 0; i < 1024; i += 3) {
+            db->add("key-" + std::to_string(i), "new-" + std::to_string(i));
+        }
+        for (int i = 0; i < 1024; i += 5) {
+            db->remove("key-" + std::to_string(i));
+        }
+        db->add("key-7", "latest");
+
+        std::vector<std::string> keys;
+        for (int i = 0; i < 1100; i += 7) {
+            keys.push_back("key-" + std::to_string(i));
+        }
+        keys.push_back("key-7");
+        keys.push_back("absent");
+
+        const std::vector<std::string_view> key_refs(keys.begin(), keys.end());
+        const auto values = db->multi_query(key_refs);
+        ASSERT_EQ(values.size(), keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            ASSERT_EQ(values[i], db->query(keys[i])) << keys[i];
+        }
+        ASSERT_EQ(values[1], "latest");
+        ASSERT_FALSE(values.back());
+        ASSERT_TRUE(db->multi_query({}).empty());
+    }
+}
+
+TEST(db, PinIndexAndFilter)
+{
+    for (const bool pin: { false, true }) {
+        Cleanup _;
+
+        options opts;
+        opts.write_buffer_size = 1024;
+        opts.pin_index_and_filter = pin;
+        auto db = open(db_name, opts);
+
+        for (auto i: indices(opts.write_buffer_size)) {
+            db->add("key-" + std::to_string(i), "val-" + std::to_string(i));
+        }
+        for (auto i: indices(opts.write_buffer_size)) {
+            ASSERT_EQ(db->query("key-" + std::to_string(i)), "val-" + std::to_string(i));
+        }
+
+        ASSERT_EQ(db->property("cloudkv.pinned-bytes") > 0u, pin);
+        ASSERT_TRUE(db->property("cloudkv.block-cache-bytes"));
+        ASSERT_FALSE(db->property("cloudkv.unknown"));
+
+        // pinned again on reopen
+        db.reset();
+        db = open(db_name, opts);
+        ASSERT_EQ(db->property("cloudkv.pinned-bytes") > 0u, pin);
+    }
+}
+
+TEST(db, RowCache)
+{
+    Cleanup _;
+
+    options opts;
+    opts.write_buffer_size = 1024;
+    opts.row_cache_size = 1024 * 1024;
+    auto db = open(db_name, opts);
+
+    for (auto i: indices(opts.write_buffer_size)) {
+        db->add("key-" + std::to_string(i), "val-" + std::to_string(i));
+    }
+    db->remove("key-1");
+    db->add("key-1", "latest");
+    db->remove("key-2");
+
+    // push them out of memtables
+    for (auto i: indices(opts.write_buffer_size)) {
+        db->add("filler-" + std::to_string(i), "val");
+    }
+
+    // filled by the first round, served by the second
+    for (int round = 0; round < 2; ++round) {
+        for (auto i: indices(opts.write_buffer_size)) {
+            const auto expected = i == 1? std::optional<std::string>("latest"):
+                                  i == 2? std::nullopt:
+                                  std::optional("val-" + std::to_string(i));
+            ASSERT_EQ(db->query("key-" + std::to_string(i)), expected) << i;
+        }
+    }
+
+    const auto hits = db->property("cloudkv.row-cache-hits").value();
+    const auto misses = db->property("cloudkv.row-cache-misses").value();
+    ASSERT_EQ(hits, opts.write_buffer_size);
+    ASSERT_EQ(misses, opts.write_buffer_size);
+    ASSERT_GT(db->property("cloudkv.row-cache-bytes").value(), 0);
+
+    const auto values = db->multi_query({ "key-3", "key-2", "key-x" });
+    ASSERT_EQ(values[0], "val-3");
+    ASSERT_FALSE(values[1]);
+    ASSERT_FALSE(values[2]);
+    ASSERT_EQ(db->property("cloudkv.row-cache-hits").value(), hits + 2);
+
+    // invalidated by writes
+    db->add("key-3", "changed");
+    db->remove("key-4");
+    ASSERT_EQ(db->query("key-3"), "changed");
+    ASSERT_FALSE(db->query("key-4"));
+}
+
+TEST(db, BlobFiles)
+{
+    Cleanup _;
+
+    options opts;
+    opts.write_buffer_size = 4096;
+    opts.min_blob_size = 256;
+    auto db = open(db_name, opts);
+
+    auto big_value = [](int i, int version) {
+        auto v = fmt::format("val-{}-{}:", i, version);
+        v.resize(300, 'x');
+        return v;
+    };
+
+    const int count = 256;
+    for (int i = 0; i < count; ++i) {
+        db->add("key-" + std::to_string(i), big_value(i, 0));
+    }
+    for (int i = 0; i < count / 2; ++i) {
+        db->add("key-" + std::to_string(i), big_value(i, 1));
+    }
+    db->remove("key-200");
+
+    // push them out of memtables
+    for (int i = 0; i < 256; ++i) {
+        db->add("filler-" + std::to_string(i), "val");
+    }
+
+    auto expected = [&](int i) {
+        return i == 200? std::nullopt: std::optional(big_value(i, i < count / 2? 1: 0));
+    };
+
+    for (int i = 0; i < count; ++i) {
+        ASSERT_EQ(db->query("key-" + std::to_string(i)), expected(i)) << i;
+    }
+
+    const auto values = db->multi_query({ "key-1", "key-200", "key-255" });
+    ASSERT_EQ(values[0], expected(1));
+    ASSERT_EQ(values[1], expected(200));
+    ASSERT_EQ(values[2], expected(255));
+
+    // values read by iterators are resolved too
+    int seen = 0;
+    auto it = db->iter();
+    for (it->seek("key-"); !it->is_eof() && it->current().key.substr(0, 4) == "key-"; it->next()) {
+        ASSERT_EQ(it->current().value.size(), 300);
+        ASSERT_EQ(it->current().value.substr(0, 4), "val-");
+        ++seen;
+    }
+    ASSERT_EQ(seen, count - 1);
+    ASSERT_GT(db->property("cloudkv.blob-bytes").value(), 0);
+
+    // blob files are kept in meta
+    db.reset();
+    db = open(db_name, opts);
+
+    ASSERT_GT(db->property("cloudkv.blob-bytes").value(), 0);
+    for (int i = 0; i < count; ++i) {
+        ASSERT_EQ(db->query("key-" + std::to_string(i)), expected(i)) << i;
+    }
+}
+
+TEST(db, PinnableQuery)
+{
+    Cleanup _;
+
+    options opts;
+    opts.write_buffer_size = 1024;
+    auto db = open(db_name, opts);
+
+    for (auto i: indices(opts.write_buffer_size)) {
+        db->add("key-" + std::to_string(i), "val-" + std::to_string(i));
+    }
+    db->remove("key-2");
+
+    // push them out of memtables
+    for (auto i: indices(opts.write_buffer_size)) {
+        db->add("filler-" + std::to_string(i), "val");
+    }
+    db->add("key-3", "in memtable");
+
+    pinnable_value value;
+    ASSERT_TRUE(db->query("key-1", &value));
+    ASSERT_EQ(value.value(), "val-1");
+    ASSERT_TRUE(value.is_pinned());
+
+    // moves keep the pin
+    pinnable_value moved(std::move(value));
+    ASSERT_EQ(moved.value(), "val-1");
+    ASSERT_FALSE(value.is_pinned());
+
+    ASSERT_FALSE(db->query("key-2", &value));
+    ASSERT_FALSE(db->query("key-x", &value));
+    ASSERT_TRUE(value.value().empty());
+
+    ASSERT_TRUE(db->query("key-3", &value));
+    ASSERT_EQ(value.value(), "in memtable");
+    ASSERT_FALSE(value.is_pinned());
+
+    moved = std::move(value);
+    ASSERT_EQ(moved.value(), "in memtable");
+
+    auto& self = moved;
+    moved = std::move(self);
+    ASSERT_EQ(moved.value(), "in memtable");
+}
@@ -0,0 +1,64 @@
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <gtest/gtest.h>
+#include "util/direct_filebuf.h"
+#include "util/random_access_file.h"
+#include "test_util.h"
+
+using namespace cloudkv;
+
+namespace {
+
+std::string read_all(const path_t& p)
+{
+    std::ifstream ifs(p, std::ios::binary);
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+
+    return ss.str();
+}
+
+}
+
+TEST(direct_filebuf, Write)
+{
+    ScopedTmpDir dir { __func__ };
+
+    const auto p = dir.path / "1";
+    std::string expected;
+    {
+        // a small buffer, so writes both fill it and leave partial pages
+        direct_filebuf buf(p, 8192);
+        std::ostream out(&buf);
+        out.exceptions(std::ios::failbit | std::ios::badbit);
+
+        for (int i = 0; i < 2000; ++i) {
+            const auto s = std::to_string(i) + std::string(i % 37, 'a' + i % 26);
+            out.write(s.data(), s.size());
+            expected += s;
+
+            ASSERT_EQ(out.tellp(), expected.size());
+            if (i % 300 == 0) {
+                out.flush();
+                ASSERT_EQ(read_all(p), expected) << i;
+            }
+        }
+
+        out.flush();
+        ASSERT_EQ(read_all(p), expected);
+
+        out.write("tail", 4);
+        expected += "tail";
+    }
+
+    ASSERT_EQ(read_all(p), expected);
+
+    random_access_file file(p, false, access_hint::normal, true);
+    std::string scratch;
+    for (const std::uint64_t offset: { 0, 1, 4095, 4096, 5000 }) {
+        ASSERT_EQ(file.read(offset, expected.size() - offset, &scratch), expected.substr(offset));
+        ASSERT_EQ(file.read(offset, 7, &scratch), expected.substr(offset, 7));
+    }
+}
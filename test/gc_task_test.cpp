@@ -1,6 +1,8 @@
 #include <filesystem>
 #include <gtest/gtest.h>
 #include "task/gc_task.h"
+#include "blob/blob_file.h"
+#include "sstable/sstable_builder.h"
 #include "test_util.h"
 
 using namespace std;
@@ -122,4 +124,50 @@ TEST(gc_task, SstableGC)
     for (const auto& p: nonreachable) {
         ASSERT_FALSE(fs::exists(p));
     }
-}
\ No newline at end of file
+}
+
+TEST(gc_task, BlobGC)
+{
+    auto db_root = fs::temp_directory_path() / test_db;
+    DBCleaner _(db_root);
+
+    path_conf db_path(db_root);
+
+    fs::create_directory(db_path.root());
+    fs::create_directory(db_path.redo_dir());
+    fs::create_directory(db_path.sst_dir());
+    fs::create_directory(db_path.blob_dir());
+
+    for (int i = 1; i <= 3; ++i) {
+        create_file(db_path.blob_path(i));
+    }
+
+    // blob 1 is referred to by a live sstable, blob 2 is being written
+    std::string ref;
+    blob_ref{ 1, 0, 100 }.encode_to(&ref);
+    {
+        sstable_builder builder(options{}, db_path.sst_path(10));
+        builder.add(internal_key("key", key_type::blob_index).underlying_key(), ref);
+        builder.done();
+    }
+    auto sst = std::make_shared<sstable>(db_path.sst_path(10));
+    ASSERT_EQ(sst->blob_files(), std::vector<std::uint64_t>{ 1 });
+
+    gc_root gc;
+    gc.add(sst);
+    gc.add_temporary(db_path.blob_path(2));
+
+    gc_task(db_path, gc, 0).run();
+
+    ASSERT_TRUE(fs::exists(db_path.blob_path(1)));
+    ASSERT_TRUE(fs::exists(db_path.blob_path(2)));
+    ASSERT_FALSE(fs::exists(db_path.blob_path(3)));
+
+    // released along with the sstable
+    sst.reset();
+    gc.remove_temporary(db_path.blob_path(2));
+    gc_task(db_path, gc, 0).run();
+
+    ASSERT_FALSE(fs::exists(db_path.blob_path(1)));
+    ASSERT_FALSE(fs::exists(db_path.blob_path(2)));
+}
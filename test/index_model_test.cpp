@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include <fmt/core.h>
+#include <gtest/gtest.h>
+#include "cloudkv/exception.h"
+#include "sstable/index_model.h"
+
+using namespace cloudkv;
+
+namespace {
+
+void expect_covered(const index_model& model, const std::vector<std::string>& keys)
+{
+    for (std::uint32_t i = 0; i < keys.size(); ++i) {
+        const auto window = model.predict(keys[i]);
+        ASSERT_TRUE(window);
+        ASSERT_LE(window->first, i) << keys[i];
+        ASSERT_GE(window->last, i) << keys[i];
+        ASSERT_LE(window->last - window->first, 2 * model.max_error() + 1);
+    }
+}
+
+}
+
+TEST(index_model, Empty)
+{
+    index_model model;
+    ASSERT_FALSE(model.predict("key"));
+
+    // too few keys to model
+    index_model_builder builder(4);
+    builder.add("a");
+    builder.add("b");
+    ASSERT_TRUE(builder.done().empty());
+    ASSERT_TRUE(builder.empty());
+}
+
+TEST(index_model, DecimalKeys)
+{
+    std::mt19937_64 engine(0);
+    std::vector<std::string> keys;
+    for (int i = 0; i < 4096; ++i) {
+        keys.push_back(fmt::format("{:016}", engine() % 100000000));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    index_model_builder builder(4);
+    for (const auto& k: keys) {
+        builder.add(k);
+    }
+
+    index_model model(builder.done());
+    ASSERT_LE(model.max_error(), 6);
+    ASSERT_LT(model.segment_count(), keys.size() / 16);
+    expect_covered(model, keys);
+
+    // keys out of range are predicted at the ends
+    ASSERT_EQ(model.predict("")->first, 0);
+    ASSERT_EQ(model.predict("9999999999999999")->last, keys.size());
+}
+
+TEST(index_model, BinaryKeys)
+{
+    std::vector<std::string> keys;
+    for (std::uint64_t i = 0; i < 1024; ++i) {
+        // big endian ids with gaps
+        const auto id = i * i * 7;
+        std::string k = "id/";
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            k.push_back(static_cast<char>(id >> shift));
+        }
+        keys.push_back(k);
+    }
+
+    index_model_builder builder(4);
+    for (const auto& k: keys) {
+        builder.add(k);
+    }
+
+    const auto content = builder.done();
+    ASSERT_FALSE(content.empty());
+    expect_covered(index_model(content), keys);
+}
+
+TEST(index_model, Skewed)
+{
+    // no slope fits few keys per segment, nothing is recorded
+    std::vector<std::string> keys;
+    std::uint64_t x = 1;
+    for (int i = 0; i < 60; ++i, x *= 2) {
+        keys.push_back(fmt::format("{:020}", x));
+    }
+
+    index_model_builder builder(0);
+    for (const auto& k: keys) {
+        builder.add(k);
+    }
+    ASSERT_TRUE(builder.done().empty());
+}
+
+TEST(index_model, Corrupted)
+{
+    ASSERT_THROW(index_model{ "abc" }, data_corrupted);
+}
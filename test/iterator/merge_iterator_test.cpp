@@ -1,4 +1,6 @@
 #include <cstddef>
+#include <map>
+#include <fmt/core.h>
 #include <gtest/gtest.h>
 #include "memtable/memtable.h"
 #include "iterator/merge_iterator.h"
@@ -149,4 +151,100 @@ TEST(merge_iterator, PutAfterDelete)
             ASSERT_EQ(v, kv_iter->second);
         }
     }
-}
\ No newline at end of file
+}
+TEST(merge_iterator, ManyChildren)
+{
+    const int children = 16;
+    const int keys = 1000;
+
+    // child c holds keys divisible by c + 1, valued by c, so the latest child dividing a key wins
+    std::vector<memtable> memtables(children);
+    std::map<std::string, std::string> answer;
+    for (int c = 0; c < children; ++c) {
+        for (int k = 0; k < keys; k += c + 1) {
+            const auto key = fmt::format("key-{:04}", k);
+            memtables[c].add(key_type::value, key, std::to_string(c));
+            answer[key] = std::to_string(c);
+        }
+    }
+
+    std::vector<iter_ptr> iterators;
+    for (auto& mt: memtables) {
+        iterators.push_back(mt.iter());
+    }
+    auto iter = std::make_unique<merge_iterator>(std::move(iterators));
+
+    auto answer_iter = answer.begin();
+    for (iter->seek_first(); !iter->is_eof(); iter->next(), ++answer_iter) {
+        ASSERT_TRUE(answer_iter != answer.end());
+
+        const auto [k, v] = iter->current();
+        ASSERT_EQ(extract_user_key(k), answer_iter->first);
+        ASSERT_EQ(v, answer_iter->second);
+    }
+    ASSERT_TRUE(answer_iter == answer.end());
+
+    iter->seek("key-0500");
+    ASSERT_FALSE(iter->is_eof());
+    ASSERT_EQ(extract_user_key(iter->current().key), "key-0500");
+    ASSERT_EQ(iter->current().value, answer["key-0500"]);
+
+    iter->seek("key-0999~");
+    ASSERT_TRUE(iter->is_eof());
+}
+
+TEST(merge_iterator, Reverse)
+{
+    const int children = 8;
+    const int keys = 500;
+
+    std::vector<memtable> memtables(children);
+    std::map<std::string, std::string> answer;
+    for (int c = 0; c < children; ++c) {
+        for (int k = 0; k < keys; k += c + 2) {
+            const auto key = fmt::format("key-{:04}", k);
+            memtables[c].add(key_type::value, key, std::to_string(c));
+            answer[key] = std::to_string(c);
+        }
+    }
+
+    std::vector<iter_ptr> iterators;
+    for (auto& mt: memtables) {
+        iterators.push_back(mt.iter());
+    }
+    auto iter = std::make_unique<merge_iterator>(std::move(iterators));
+
+    auto answer_iter = answer.rbegin();
+    for (iter->seek_last(); !iter->is_eof(); iter->prev(), ++answer_iter) {
+        ASSERT_TRUE(answer_iter != answer.rend());
+
+        const auto [k, v] = iter->current();
+        ASSERT_EQ(extract_user_key(k), answer_iter->first);
+        ASSERT_EQ(v, answer_iter->second);
+    }
+    ASSERT_TRUE(answer_iter == answer.rend());
+
+    iter->seek_for_prev("key-0251");
+    ASSERT_FALSE(iter->is_eof());
+    ASSERT_EQ(extract_user_key(iter->current().key), "key-0250");
+    ASSERT_EQ(iter->current().value, answer["key-0250"]);
+
+    // switching direction neither repeats nor skips keys
+    auto expected = answer.find("key-0250");
+    for (int step = 0; step < 64; ++step) {
+        if (step % 3 == 0) {
+            iter->prev();
+            --expected;
+        } else {
+            iter->next();
+            ++expected;
+        }
+
+        ASSERT_FALSE(iter->is_eof());
+        ASSERT_EQ(extract_user_key(iter->current().key), expected->first) << step;
+        ASSERT_EQ(iter->current().value, expected->second);
+    }
+
+    iter->seek_for_prev("key-");
+    ASSERT_TRUE(iter->is_eof());
+}
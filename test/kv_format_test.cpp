@@ -0,0 +1,36 @@
+#include <string>
+#include <gtest/gtest.h>
+#include "cloudkv/exception.h"
+#include "kv_format.h"
+
+using namespace cloudkv;
+
+TEST(kv_format, InternalKeyRef)
+{
+    const internal_key owned("key", key_type::tombsome);
+    const std::string buf(owned.underlying_key());
+
+    const auto ref = internal_key_ref::parse(buf);
+    ASSERT_EQ(ref.user_key(), "key");
+    ASSERT_EQ(ref.type(), key_type::tombsome);
+    ASSERT_TRUE(ref.is_deleted());
+    ASSERT_EQ(ref.user_key().data(), buf.data());
+    ASSERT_EQ(ref, owned.ref());
+    ASSERT_TRUE(internal_key(ref) == owned);
+
+    EXPECT_THROW(internal_key_ref::parse("k"), data_corrupted);
+    EXPECT_THROW(internal_key_ref::parse(std::string("key\x07", 4)), data_corrupted);
+}
+
+TEST(kv_format, Compare)
+{
+    const internal_key a("ab", key_type::blob_index);
+    const internal_key b(std::string("ab\x01", 3), key_type::value);
+    const internal_key c("ab", key_type::value);
+
+    // user keys first, raw bytes would put b first
+    ASSERT_LT(a.ref().compare(b.ref()), 0);
+    ASSERT_TRUE(a.ref() < b.ref());
+    ASSERT_TRUE(c.ref() < a.ref());
+    ASSERT_EQ(c.ref().compare(c.ref()), 0);
+}
@@ -117,4 +117,41 @@ TEST(memtable, IterSeek)
 
     it->seek("8");
     ASSERT_TRUE(it->is_eof());
-}
\ No newline at end of file
+}
+TEST(memtable, IterReverse)
+{
+    memtable mt;
+    mt.add(key_type::value, "1", "1");
+    mt.add(key_type::value, "2", "2");
+    mt.add(key_type::value, "5", "5");
+    mt.add(key_type::value, "7", "7");
+
+    auto it = mt.iter();
+    std::string keys;
+    for (it->seek_last(); !it->is_eof(); it->prev()) {
+        keys += internal_key::parse(it->current().key).user_key();
+    }
+    ASSERT_EQ(keys, "7521");
+
+    it->seek_for_prev("4");
+    ASSERT_FALSE(it->is_eof());
+    ASSERT_EQ(internal_key::parse(it->current().key).user_key(), "2");
+    it->next();
+    ASSERT_EQ(it->current().value, "5");
+
+    it->seek_for_prev("0");
+    ASSERT_TRUE(it->is_eof());
+
+    // from a forward position
+    it->seek("5");
+    it->prev();
+    ASSERT_FALSE(it->is_eof());
+    ASSERT_EQ(it->current().value, "2");
+
+    // entries added after the first backward move are only seen going forward
+    mt.add(key_type::value, "6", "6");
+    it->seek("6");
+    ASSERT_EQ(it->current().value, "6");
+    it->prev();
+    ASSERT_EQ(it->current().value, "5");
+}
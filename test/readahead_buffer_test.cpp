@@ -0,0 +1,76 @@
+#include <string>
+#include <gtest/gtest.h>
+#include "cloudkv/exception.h"
+#include "util/readahead_buffer.h"
+#include "test_util.h"
+
+using namespace cloudkv;
+
+namespace {
+
+std::string make_data(std::size_t size)
+{
+    std::string data(size, '\0');
+    for (std::size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<char>(i * 131 + i / 256);
+    }
+
+    return data;
+}
+
+}
+
+TEST(readahead_buffer, Sequential)
+{
+    ScopedTmpDir dir { __func__ };
+
+    const auto data = make_data(4 * 1024 * 1024 + 123);
+    create_file(dir.path / "1", data);
+
+    for (const bool use_mmap: { false, true }) {
+        random_access_file file(dir.path / "1", use_mmap);
+        readahead_buffer readahead(1024 * 1024);
+
+        std::string scratch;
+        std::uint64_t offset = 0;
+        for (std::uint64_t length = 1000; offset < data.size(); offset += length) {
+            length = std::min<std::uint64_t>(length + 7, data.size() - offset);
+
+            const auto r = readahead.read(file, offset, length, &scratch);
+            ASSERT_EQ(r, std::string_view(data).substr(offset, length)) << offset;
+        }
+
+        // grows up to the max once reads turn sequential
+        ASSERT_EQ(readahead.readahead(), 1024 * 1024);
+        ASSERT_THROW(readahead.read(file, data.size() - 10, 11, &scratch), data_corrupted);
+    }
+}
+
+TEST(readahead_buffer, Random)
+{
+    ScopedTmpDir dir { __func__ };
+
+    const auto data = make_data(1024 * 1024);
+    create_file(dir.path / "1", data);
+
+    random_access_file file(dir.path / "1");
+    readahead_buffer readahead(1024 * 1024);
+
+    std::string scratch;
+    for (const std::uint64_t offset: { 5000, 100, 90000, 300, 700000, 20 }) {
+        const auto r = readahead.read(file, offset, 4096, &scratch);
+        ASSERT_EQ(r, std::string_view(data).substr(offset, 4096));
+        ASSERT_EQ(r.data(), scratch.data());
+        ASSERT_EQ(readahead.readahead(), 0);
+    }
+
+    // reads after the sequential ones come from the chunk read ahead
+    readahead.read(file, 0, 100, &scratch);
+    readahead.read(file, 100, 100, &scratch);
+    for (const std::uint64_t offset: { 200, 300 }) {
+        const auto r = readahead.read(file, offset, 100, &scratch);
+        ASSERT_EQ(r, std::string_view(data).substr(offset, 100));
+        ASSERT_NE(r.data(), scratch.data());
+        ASSERT_GT(readahead.readahead(), 0);
+    }
+}
@@ -1,5 +1,8 @@
+#include <fstream>
 #include <gtest/gtest.h>
+#include "cloudkv/exception.h"
 #include "memtable/redolog.h"
+#include "memtable/redolog_reader.h"
 #include "write_batch_accessor.h"
 #include "test_util.h"
 
@@ -17,4 +20,49 @@ TEST(redolog, Write)
     redo.write(write_batch_accessor(batch).to_bytes());
 
     EXPECT_TRUE(fs::file_size(p) > 0);
-}
\ No newline at end of file
+}
+
+TEST(redolog, Checksum)
+{
+    auto p = fs::temp_directory_path() / "test";
+    fs::remove(p);
+
+    {
+        redolog redo { p };
+        redo.write("record-1");
+        redo.write("record-2");
+    }
+
+    {
+        redolog_reader reader(p);
+        ASSERT_EQ(reader.next(), "record-1");
+        ASSERT_EQ(reader.next(), "record-2");
+        ASSERT_FALSE(reader.next());
+    }
+
+    // flip a byte of the last record
+    {
+        std::fstream f(p, std::ios::binary | std::ios::in | std::ios::out);
+        f.seekp(-1, std::ios::end);
+        f.put('x');
+    }
+
+    redolog_reader reader(p);
+    ASSERT_EQ(reader.next(), "record-1");
+    ASSERT_THROW(reader.next(), data_corrupted);
+}
+
+TEST(redolog, ReadLegacyRecord)
+{
+    auto p = fs::temp_directory_path() / "test";
+    fs::remove(p);
+
+    std::string buf;
+    PutFixed32(&buf, 6);
+    buf.append("record");
+    create_file(p, buf);
+
+    redolog_reader reader(p);
+    ASSERT_EQ(reader.next(), "record");
+    ASSERT_FALSE(reader.next());
+}
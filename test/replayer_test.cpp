@@ -26,7 +26,7 @@ TEST(replayer, EmptyRedo)
     create_file(db_path.redo_path(30));
 
     file_id_allocator id_alloc;
-    auto res = replayer(db_path, id_alloc, 5).replay();
+    auto res = replayer(db_path, options{}, id_alloc, 5).replay();
     ASSERT_EQ(res.replayed_file_id, 5);
     ASSERT_TRUE(res.sstables.empty());
 }
@@ -42,7 +42,7 @@ TEST(replayer, BadRedo)
     create_file(db_path.redo_path(10), "1234567");
 
     file_id_allocator id_alloc;
-    auto res = replayer(db_path, id_alloc, 5).replay();
+    auto res = replayer(db_path, options{}, id_alloc, 5).replay();
     ASSERT_EQ(res.replayed_file_id, 5);
     ASSERT_TRUE(res.sstables.empty());
 }
@@ -71,7 +71,7 @@ TEST(replayer, Replay)
     }
 
     file_id_allocator id_alloc;
-    auto res = replayer(db_path, id_alloc, persisted_file_id).replay();
+    auto res = replayer(db_path, options{}, id_alloc, persisted_file_id).replay();
     ASSERT_EQ(res.replayed_file_id, max_file_id);
     ASSERT_EQ(res.sstables.size(), max_file_id - persisted_file_id);
 }
\ No newline at end of file
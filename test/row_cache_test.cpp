@@ -0,0 +1,79 @@
+#include <string>
+#include <gtest/gtest.h>
+#include "row_cache.h"
+
+using namespace cloudkv;
+
+TEST(row_cache, Basic)
+{
+    row_cache cache(1024 * 1024);
+
+    ASSERT_FALSE(cache.find("k1"));
+    cache.insert("k1", cache.version("k1"), "v1");
+    cache.insert("k2", cache.version("k2"), std::nullopt);
+
+    const auto r1 = cache.find("k1");
+    ASSERT_TRUE(r1);
+    ASSERT_FALSE(r1->deleted);
+    ASSERT_EQ(r1->value, "v1");
+
+    const auto r2 = cache.find("k2");
+    ASSERT_TRUE(r2);
+    ASSERT_TRUE(r2->deleted);
+
+    ASSERT_EQ(cache.hits(), 2);
+    ASSERT_EQ(cache.misses(), 1);
+
+    cache.invalidate("k1");
+    ASSERT_FALSE(cache.find("k1"));
+    ASSERT_EQ(r1->value, "v1");
+    ASSERT_EQ(cache.misses(), 2);
+}
+
+TEST(row_cache, StaleFill)
+{
+    row_cache cache(1024 * 1024);
+
+    // a write between the version taken and the fill wins
+    const auto version = cache.version("k");
+    cache.invalidate("k");
+    cache.insert("k", version, "old");
+    ASSERT_FALSE(cache.find("k"));
+
+    cache.insert("k", cache.version("k"), "new");
+    ASSERT_EQ(cache.find("k")->value, "new");
+}
+
+TEST(row_cache, Bounded)
+{
+    row_cache cache(64 * 1024);
+
+    for (int i = 0; i < 10000; ++i) {
+        const auto key = "key-" + std::to_string(i);
+        cache.insert(key, cache.version(key), std::string(100, 'x'));
+    }
+
+    ASSERT_LE(cache.bytes_used(), 64 * 1024 + 16 * 1024);
+    ASSERT_TRUE(cache.find("key-9999"));
+}
+
+TEST(row_cache, LongKeys)
+{
+    row_cache cache(64 * 1024);
+
+    // beyond small string buffers, replaced and evicted through views of owned keys
+    auto key_of = [](int i) { return std::string(64, 'k') + std::to_string(i); };
+    for (int round = 0; round < 2; ++round) {
+        for (int i = 0; i < 2000; ++i) {
+            const auto key = key_of(i);
+            cache.insert(key, cache.version(key), std::to_string(round));
+        }
+    }
+
+    ASSERT_LE(cache.bytes_used(), 64 * 1024 + 16 * 1024);
+    ASSERT_EQ(cache.find(key_of(1999))->value, "1");
+    ASSERT_FALSE(cache.find(key_of(0)));
+
+    cache.invalidate(key_of(1999));
+    ASSERT_FALSE(cache.find(key_of(1999)));
+}
@@ -1,10 +1,15 @@
+#include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
 #include "sstable/format.h"
+#include "util/random_access_file.h"
 #include "cloudkv/exception.h"
 
 using namespace cloudkv;
 using namespace cloudkv::sst;
 
+namespace fs = std::filesystem;
+
 namespace cloudkv::sst {
 
 inline bool operator==(block_handle a, block_handle b)
@@ -52,4 +57,57 @@ TEST(sst_format, Footer)
 
     ++buf.back();
     ASSERT_THROW(footer{buf}, data_corrupted);
-}
\ No newline at end of file
+}
+
+TEST(sst_format, LegacyFooter)
+{
+    block_handle dataindex(0, 128);
+    block_handle metaindex(256, 1024);
+
+    std::string buf;
+    dataindex.encode_to(&buf);
+    metaindex.encode_to(&buf);
+    PutFixed64(&buf, footer::table_magic_legacy);
+
+    footer foot(buf);
+    ASSERT_FALSE(foot.has_block_trailer());
+    ASSERT_EQ(foot.data_index(), dataindex);
+    ASSERT_TRUE(footer(dataindex, metaindex).has_block_trailer());
+}
+
+TEST(sst_format, BlockTrailer)
+{
+    const auto p = fs::temp_directory_path() / "sst_format.BlockTrailer";
+
+    const std::string content = "some block content";
+    std::string buf = content;
+    encode_block_trailer(content, compression_type::none, &buf);
+    ASSERT_EQ(buf.size(), content.size() + block_trailer_size);
+
+    const block_handle handle(0, content.size());
+    for (const bool use_mmap: { false, true }) {
+        {
+            std::ofstream out(p, std::ios::binary);
+            out.write(buf.data(), buf.size());
+        }
+
+        random_access_file file(p, use_mmap);
+        std::string scratch;
+        ASSERT_EQ(read_block_content(file, handle, true, true, &scratch), content);
+        ASSERT_EQ(read_block_content(file, handle, false, true, &scratch), content);
+        ASSERT_THROW(read_block_content(file, block_handle(0, content.size() + 1), true, true, &scratch), data_corrupted);
+    }
+
+    buf[3] ^= 0x10;
+    {
+        std::ofstream out(p, std::ios::binary);
+        out.write(buf.data(), buf.size());
+    }
+
+    random_access_file file(p);
+    std::string scratch;
+    ASSERT_THROW(read_block_content(file, handle, true, true, &scratch), data_corrupted);
+    ASSERT_NE(read_block_content(file, handle, true, false, &scratch), content);
+
+    fs::remove(p);
+}
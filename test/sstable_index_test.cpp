@@ -0,0 +1,94 @@
+#include <vector>
+#include <gtest/gtest.h>
+#include "sstable/sstable_index.h"
+#include "test_util.h"
+
+using namespace std;
+using namespace cloudkv;
+
+namespace {
+
+// user keys in [from, to)
+sstable_ptr make_range_sst(const path_t& p, int from, int to)
+{
+    sstable_builder builder(options{}, p);
+    for (int i = from; i < to; ++i) {
+        builder.add(internal_key{ fmt::format("{:04}", i), key_type::value }.underlying_key(), "v");
+    }
+
+    builder.done();
+    return std::make_shared<sstable>(p);
+}
+
+std::string key_of(int i)
+{
+    return fmt::format("{:04}", i);
+}
+
+}
+
+TEST(sstable_index, Empty)
+{
+    sstable_index index({});
+
+    ASSERT_TRUE(index.all().empty());
+    ASSERT_TRUE(index.covering("a").empty());
+    ASSERT_TRUE(index.overlapping("", "").empty());
+}
+
+TEST(sstable_index, Disjoint)
+{
+    ScopedTmpDir dir { __func__ };
+
+    // oldest first
+    std::vector<sstable_ptr> sstables;
+    for (int i = 0; i < 10; ++i) {
+        sstables.push_back(make_range_sst(dir.path / std::to_string(i), i * 100, i * 100 + 50));
+    }
+
+    sstable_index index(sstables);
+    ASSERT_EQ(index.all().size(), sstables.size());
+    ASSERT_EQ(index.all().front(), sstables.back());
+
+    for (int i = 0; i < 10; ++i) {
+        const auto r = index.covering(key_of(i * 100 + 10));
+        ASSERT_EQ(r.size(), 1);
+        ASSERT_EQ(r.front(), sstables[i]);
+
+        ASSERT_TRUE(index.covering(key_of(i * 100 + 60)).empty());
+    }
+
+    ASSERT_EQ(index.overlapping(key_of(120), key_of(300)).size(), 2);
+    ASSERT_EQ(index.overlapping(key_of(120), key_of(301)).size(), 3);
+    ASSERT_EQ(index.overlapping(key_of(160), key_of(200)).size(), 0);
+    ASSERT_EQ(index.overlapping("", key_of(200)).size(), 2);
+    ASSERT_EQ(index.overlapping(key_of(820), "").size(), 2);
+    ASSERT_EQ(index.overlapping("", "").size(), sstables.size());
+}
+
+TEST(sstable_index, OverlapNewestFirst)
+{
+    ScopedTmpDir dir { __func__ };
+
+    std::vector<sstable_ptr> sstables;
+    sstables.push_back(make_range_sst(dir.path / "0", 0, 1000));
+    sstables.push_back(make_range_sst(dir.path / "1", 100, 200));
+    sstables.push_back(make_range_sst(dir.path / "2", 500, 600));
+    sstables.push_back(make_range_sst(dir.path / "3", 150, 550));
+
+    sstable_index index(sstables);
+
+    auto r = index.covering(key_of(160));
+    ASSERT_EQ(r, (std::vector<sstable_ptr>{ sstables[3], sstables[1], sstables[0] }));
+
+    r = index.covering(key_of(520));
+    ASSERT_EQ(r, (std::vector<sstable_ptr>{ sstables[3], sstables[2], sstables[0] }));
+
+    r = index.covering(key_of(999));
+    ASSERT_EQ(r, (std::vector<sstable_ptr>{ sstables[0] }));
+
+    ASSERT_TRUE(index.covering(key_of(1000)).empty());
+
+    r = index.overlapping(key_of(50), key_of(150));
+    ASSERT_EQ(r, (std::vector<sstable_ptr>{ sstables[1], sstables[0] }));
+}
@@ -1,6 +1,10 @@
+#include <fstream>
 #include <map>
+#include <random>
 #include <gtest/gtest.h>
+#include "cloudkv/exception.h"
 #include "sstable/sstable.h"
+#include "sstable/table_cache.h"
 #include "test_util.h"
 
 using namespace std;
@@ -81,4 +85,555 @@ TEST(sstable, QueryRange)
     }
 
     ASSERT_EQ(it2, kv.end());
-}
\ No newline at end of file
+}
+TEST(sstable, Filter)
+{
+    ScopedTmpDir dir { __func__ };
+
+    const int key_cnt = 1024;
+    auto sst = make_sst_in_kv_format(dir.path / "1", 0, key_cnt);
+
+    for (const auto i: views::ints(0, key_cnt)) {
+        ASSERT_TRUE(sst->may_contain("key-" + std::to_string(i)));
+    }
+
+    int false_positives = 0;
+    for (const auto i: views::ints(key_cnt, key_cnt * 2)) {
+        if (sst->may_contain("key-" + std::to_string(i))) {
+            ++false_positives;
+        }
+    }
+    ASSERT_LT(false_positives, key_cnt / 20);
+}
+
+TEST(sstable, Get)
+{
+    ScopedTmpDir dir { __func__ };
+
+    const int key_cnt = 4096;
+    auto sst = make_sst_in_kv_format(dir.path / "1", 0, key_cnt);
+
+    for (const bool use_mmap: { false, true }) {
+        block_cache blocks(1024 * 1024);
+        table_cache cache(16, { &blocks, use_mmap, access_hint::random });
+        std::string scratch;
+
+        for (const auto i: views::ints(0, key_cnt)) {
+            const auto key = "key-" + std::to_string(i);
+            const auto r = sst->get(cache, key, {}, &scratch);
+            ASSERT_TRUE(r);
+            ASSERT_EQ(extract_user_key(r->key), key);
+            ASSERT_EQ(extract_key_type(r->key), key_type::value);
+            ASSERT_EQ(r->value, fmt::format("val-{}-1", key));
+        }
+
+        ASSERT_FALSE(sst->get(cache, "key-", {}, &scratch));
+        ASSERT_FALSE(sst->get(cache, "key-00", {}, &scratch));
+        ASSERT_FALSE(sst->get(cache, "a", {}, &scratch));
+        ASSERT_FALSE(sst->get(cache, "z", {}, &scratch));
+    }
+}
+
+TEST(sstable, Checksum)
+{
+    ScopedTmpDir dir { __func__ };
+
+    const auto p = dir.path / "1";
+    auto sst = make_sst_in_kv_format(p, 0, 4096);
+
+    // corrupt the first data block only, which the index and meta blocks follow
+    {
+        std::fstream f(p, std::ios::binary | std::ios::in | std::ios::out);
+        f.seekp(16);
+        f.put('\xff');
+    }
+
+    for (const bool use_mmap: { false, true }) {
+        table_cache cache(16, { nullptr, use_mmap });
+        std::string scratch;
+
+        ASSERT_THROW(sst->get(cache, "key-0", {}, &scratch), data_corrupted);
+        ASSERT_NO_THROW(sst->get(cache, "key-999", {}, &scratch));
+
+        auto it = sst->iter(cache);
+        ASSERT_THROW(it->seek_first(), data_corrupted);
+    }
+
+    ASSERT_THROW(sst->iter()->seek_first(), data_corrupted);
+
+    // blocks read unverified are not cached for verifying reads
+    block_cache blocks(1024 * 1024);
+    table_cache cache(16, { &blocks });
+    std::string scratch;
+
+    read_options unverified;
+    unverified.verify_checksums = false;
+    try {
+        sst->get(cache, "key-0", unverified, &scratch);
+    } catch (data_corrupted&) {
+        // the corrupted content may fail to decode anyway
+    }
+
+    ASSERT_THROW(sst->get(cache, "key-0", {}, &scratch), data_corrupted);
+    ASSERT_THROW(sst->iter(cache)->seek_first(), data_corrupted);
+}
+
+TEST(sstable, Compression)
+{
+    ScopedTmpDir dir { __func__ };
+
+    // values as the bench writes
+    std::map<std::string, std::string> kv;
+    for (int i = 0; i < 4096; ++i) {
+        kv.emplace(internal_key{ fmt::format("key-{:06}", i), key_type::value }.underlying_key(), std::string(128, ' '));
+    }
+
+    std::uint64_t raw_size = 0;
+    for (const auto type: { compression_type::none, compression_type::lz4, compression_type::zstd }) {
+        options opts;
+        opts.compression = type;
+
+        const auto p = dir.path / std::to_string(int(type));
+        sstable_builder builder(opts, p);
+        for (const auto& [k, v]: kv) {
+            builder.add(k, v);
+        }
+        builder.done();
+
+        auto sst = std::make_shared<sstable>(p);
+        if (type == compression_type::none) {
+            raw_size = sst->size_in_bytes();
+        } else {
+            ASSERT_LT(sst->size_in_bytes() * 4, raw_size);
+        }
+
+        for (const bool use_mmap: { false, true }) {
+            block_cache blocks(1024 * 1024);
+            table_cache cache(16, { &blocks, use_mmap });
+
+            auto it = sst->iter(cache);
+            auto kv_iter = kv.begin();
+            for (it->seek_first(); !it->is_eof(); it->next(), ++kv_iter) {
+                ASSERT_TRUE(kv_iter != kv.end());
+                ASSERT_EQ(it->current().key, kv_iter->first);
+                ASSERT_EQ(it->current().value, kv_iter->second);
+            }
+            ASSERT_TRUE(kv_iter == kv.end());
+
+            std::string scratch;
+            const auto r = sst->get(cache, "key-000100", {}, &scratch);
+            ASSERT_TRUE(r);
+            ASSERT_EQ(r->value, std::string(128, ' '));
+
+            // uncompressed blocks are cached, raw mapped ones are not
+            if (type != compression_type::none || !use_mmap) {
+                ASSERT_GT(blocks.bytes_used(), 0);
+            } else {
+                ASSERT_EQ(blocks.bytes_used(), 0);
+            }
+        }
+    }
+}
+
+TEST(sstable, CompressionRatioThreshold)
+{
+    ScopedTmpDir dir { __func__ };
+
+    std::mt19937 engine(1);
+    std::map<std::string, std::string> kv;
+    for (int i = 0; i < 1024; ++i) {
+        std::string v(128, '\0');
+        for (auto& c: v) {
+            c = static_cast<char>(engine());
+        }
+        kv.emplace(internal_key{ fmt::format("key-{:06}", i), key_type::value }.underlying_key(), v);
+    }
+
+    std::uint64_t sizes[2] = {};
+    for (const auto type: { compression_type::none, compression_type::lz4 }) {
+        options opts;
+        opts.compression = type;
+
+        const auto p = dir.path / std::to_string(int(type));
+        sstable_builder builder(opts, p);
+        for (const auto& [k, v]: kv) {
+            builder.add(k, v);
+        }
+        builder.done();
+
+        sizes[int(type)] = sstable(p).size_in_bytes();
+    }
+
+    // incompressible blocks are kept raw
+    ASSERT_EQ(sizes[0], sizes[1]);
+}
+
+TEST(sstable, PartitionedIndex)
+{
+    ScopedTmpDir dir { __func__ };
+
+    std::map<std::string, std::string> kv;
+    for (int i = 0; i < 8192; i += 2) {
+        kv.emplace(internal_key{ fmt::format("key-{:06}", i), key_type::value }.underlying_key(), fmt::format("value-{}", i));
+    }
+
+    options opts;
+    opts.block_size = 512;
+    opts.index_partition_size = 256;
+
+    const auto p = dir.path / "1";
+    sstable_builder builder(opts, p);
+    for (const auto& [k, v]: kv) {
+        builder.add(k, v);
+    }
+    builder.done();
+
+    auto sst = std::make_shared<sstable>(p);
+
+    // uncached readers iterate all partitions
+    auto it = sst->iter();
+    auto kv_iter = kv.begin();
+    for (it->seek_first(); !it->is_eof(); it->next(), ++kv_iter) {
+        ASSERT_TRUE(kv_iter != kv.end());
+        ASSERT_EQ(it->current().key, kv_iter->first);
+        ASSERT_EQ(it->current().value, kv_iter->second);
+    }
+    ASSERT_TRUE(kv_iter == kv.end());
+
+    for (const bool use_mmap: { false, true }) {
+        block_cache blocks(1024 * 1024);
+        table_cache cache(16, { &blocks, use_mmap });
+
+        std::string scratch;
+        for (int i = 0; i < 8191; ++i) {
+            const auto key = fmt::format("key-{:06}", i);
+            const auto r = sst->get(cache, key, {}, &scratch);
+            ASSERT_EQ(r.has_value(), i % 2 == 0) << key;
+            if (r) {
+                ASSERT_EQ(r->value, fmt::format("value-{}", i));
+            }
+
+            // seek across partition boundaries
+            auto it = sst->iter(cache);
+            it->seek(key);
+            ASSERT_FALSE(it->is_eof());
+            ASSERT_EQ(extract_user_key(it->current().key), fmt::format("key-{:06}", i + i % 2));
+        }
+
+        ASSERT_FALSE(sst->get(cache, "key-999999", {}, &scratch));
+        auto it = sst->iter(cache);
+        it->seek("key-999999");
+        ASSERT_TRUE(it->is_eof());
+    }
+}
+
+TEST(sstable, Reverse)
+{
+    ScopedTmpDir dir { __func__ };
+
+    std::map<std::string, std::string> kv;
+    for (int i = 0; i < 4096; i += 2) {
+        kv.emplace(internal_key{ fmt::format("key-{:06}", i), key_type::value }.underlying_key(), fmt::format("value-{}", i));
+    }
+
+    for (const std::uint32_t partition_size: { 0, 256 }) {
+        options opts;
+        opts.block_size = 512;
+        opts.index_partition_size = partition_size;
+
+        const auto p = dir.path / std::to_string(partition_size);
+        sstable_builder builder(opts, p);
+        for (const auto& [k, v]: kv) {
+            builder.add(k, v);
+        }
+        builder.done();
+
+        auto sst = std::make_shared<sstable>(p);
+
+        auto it = sst->iter();
+        auto kv_iter = kv.rbegin();
+        for (it->seek_last(); !it->is_eof(); it->prev(), ++kv_iter) {
+            ASSERT_TRUE(kv_iter != kv.rend());
+            ASSERT_EQ(it->current().key, kv_iter->first);
+            ASSERT_EQ(it->current().value, kv_iter->second);
+        }
+        ASSERT_TRUE(kv_iter == kv.rend());
+
+        block_cache blocks(1024 * 1024);
+        table_cache cache(16, { &blocks });
+        for (int i = 1; i < 4200; i += 7) {
+            const auto expected = fmt::format("key-{:06}", std::min(i - i % 2, 4094));
+
+            // across block and partition boundaries
+            auto it = sst->iter(cache);
+            it->seek_for_prev(fmt::format("key-{:06}", i));
+            ASSERT_FALSE(it->is_eof());
+            ASSERT_EQ(extract_user_key(it->current().key), expected);
+
+            it->prev();
+            if (expected == "key-000000") {
+                ASSERT_TRUE(it->is_eof());
+                continue;
+            }
+
+            ASSERT_FALSE(it->is_eof());
+            it->next();
+            ASSERT_EQ(extract_user_key(it->current().key), expected);
+        }
+
+        it->seek_for_prev("key-");
+        ASSERT_TRUE(it->is_eof());
+    }
+}
+
+TEST(sstable, Bounds)
+{
+    ScopedTmpDir dir { __func__ };
+
+    std::map<std::string, std::string> kv;
+    for (int i = 0; i < 4096; ++i) {
+        kv.emplace(internal_key{ fmt::format("key-{:06}", i), key_type::value }.underlying_key(), fmt::format("value-{}", i));
+    }
+
+    options opts;
+    opts.block_size = 512;
+
+    const auto p = dir.path / "1";
+    sstable_builder builder(opts, p);
+    for (const auto& [k, v]: kv) {
+        builder.add(k, v);
+    }
+    builder.done();
+
+    auto sst = std::make_shared<sstable>(p);
+    table_cache cache(16);
+
+    read_options ropts;
+    ropts.lower_bound = "key-000100";
+    ropts.upper_bound = "key-000200";
+
+    // blocks past the bound are not read, so the scan stops within a block of it
+    auto it = sst->iter(cache, ropts);
+    int seen = 0;
+    std::string last;
+    for (it->seek("key-000150"); !it->is_eof(); it->next(), ++seen) {
+        last = extract_user_key(it->current().key);
+    }
+    ASSERT_GE(last, "key-000199");
+    ASSERT_LT(seen, 150);
+
+    seen = 0;
+    for (it->seek_for_prev("key-000150"); !it->is_eof(); it->prev(), ++seen) {
+        last = extract_user_key(it->current().key);
+    }
+    ASSERT_LE(last, "key-000100");
+    ASSERT_LT(seen, 150);
+
+    it->seek("key-000200");
+    ASSERT_TRUE(it->is_eof());
+    it->seek_for_prev("key-000099");
+    ASSERT_TRUE(it->is_eof());
+}
+
+TEST(sstable, IndexModel)
+{
+    ScopedTmpDir dir { __func__ };
+
+    std::mt19937_64 engine(0);
+    std::map<std::string, std::string> kv;
+    for (int i = 0; i < 8192; ++i) {
+        const auto k = fmt::format("{:016}", engine() % 100000000);
+        kv.emplace(internal_key{ k, key_type::value }.underlying_key(), k);
+    }
+
+    options opts;
+    opts.block_size = 512;
+    opts.index_model = true;
+
+    const auto p = dir.path / "1";
+    sstable_builder builder(opts, p);
+    for (const auto& [k, v]: kv) {
+        builder.add(k, v);
+    }
+    builder.done();
+
+    auto sst = std::make_shared<sstable>(p);
+    table_cache cache(16);
+
+    std::string scratch;
+    for (const auto& [k, v]: kv) {
+        const auto r = sst->get(cache, extract_user_key(k), {}, &scratch);
+        ASSERT_TRUE(r);
+        ASSERT_EQ(r->value, v);
+    }
+    for (int i = 0; i < 8192; ++i) {
+        const auto k = fmt::format("{:016}", engine() % 100000000);
+        const auto r = sst->get(cache, k, {}, &scratch);
+        ASSERT_EQ(r.has_value(), kv.count(std::string(internal_key{ k, key_type::value }.underlying_key())) > 0);
+    }
+}
+
+TEST(sstable, MultiGet)
+{
+    ScopedTmpDir dir { __func__ };
+
+    std::vector<sstable_ptr> sstables;
+    for (int i = 0; i < 4; ++i) {
+        sstables.push_back(make_sst_in_kv_format(dir.path / std::to_string(i), i * 100, 200));
+    }
+
+    for (const bool prefer_io_uring: { true, false }) {
+        auto io = make_async_io(8, prefer_io_uring);
+        block_cache blocks(1024 * 1024);
+        table_cache cache(16, { &blocks, false, access_hint::random, io.get() });
+
+        for (int round = 0; round < 2; ++round) {
+            // blocks are read at first, then cached
+            std::vector<sstable_get> lookups;
+            for (const auto& sst: sstables) {
+                lookups.push_back({ sst.get(), "key-150" });
+                lookups.push_back({ sst.get(), "key-350" });
+                lookups.push_back({ sst.get(), "key-x" });
+            }
+
+            sstable::multi_get(cache, lookups, {});
+            for (std::size_t i = 0; i < lookups.size(); ++i) {
+                const auto& lookup = lookups[i];
+                std::string scratch;
+                const auto expected = lookup.sst->get(cache, lookup.user_key, {}, &scratch);
+
+                ASSERT_EQ(lookup.result.has_value(), expected.has_value()) << i;
+                if (expected) {
+                    ASSERT_EQ(lookup.result->key, expected->key);
+                    ASSERT_EQ(lookup.result->value, expected->value);
+                }
+            }
+
+            ASSERT_TRUE(lookups[0].result);
+            ASSERT_FALSE(lookups[2].result);
+            ASSERT_FALSE(lookups[4].result);
+            ASSERT_TRUE(lookups[7].result);
+        }
+    }
+}
+
+TEST(sstable, MultiGetSharedBlock)
+{
+    ScopedTmpDir dir { __func__ };
+
+    const auto sst = make_sst_in_kv_format(dir.path / "0", 0, 200);
+    auto io = make_async_io(8);
+    table_cache cache(16, { nullptr, false, access_hint::random, io.get() });
+
+    std::vector<std::string> keys;
+    for (int i = 100; i < 110; ++i) {
+        keys.push_back("key-" + std::to_string(i));
+    }
+
+    // adjacent keys fall in the same data block, which is read and decoded once for all of them
+    std::vector<sstable_get> lookups;
+    for (const auto& key: keys) {
+        lookups.push_back({ sst.get(), key });
+    }
+
+    sstable::multi_get(cache, lookups, {});
+    for (std::size_t i = 0; i < lookups.size(); ++i) {
+        ASSERT_TRUE(lookups[i].result) << i;
+        ASSERT_EQ(extract_user_key(lookups[i].result->key), keys[i]);
+        ASSERT_EQ(lookups[i].result->value, fmt::format("val-{}-0", keys[i]));
+    }
+    ASSERT_EQ(lookups.front().result->pin, lookups.back().result->pin);
+}
+
+TEST(sstable, Readahead)
+{
+    ScopedTmpDir dir { __func__ };
+
+    map<string, string> kv;
+    for (const auto i: views::ints(0, 20000)) {
+        kv.emplace(fmt::format("key-{:08}", i), std::string(100, 'a' + i % 26));
+    }
+
+    const auto sst = make_sst(dir.path / "1", kv);
+
+    for (const bool use_mmap: { false, true }) {
+        block_cache blocks(1024 * 1024);
+        table_cache cache(16, { &blocks, use_mmap, access_hint::normal });
+
+        read_options opts;
+        opts.readahead_size = 256 * 1024;
+
+        std::vector<iter_ptr> iters;
+        iters.push_back(sst->iter(64 * 1024));
+        iters.push_back(sst->iter(cache, opts));
+
+        // blocks spanning chunks read ahead are read again, as well as those after seeks
+        for (auto& it: iters) {
+            auto expected = kv.begin();
+            for (it->seek_first(); !it->is_eof(); it->next(), ++expected) {
+                ASSERT_NE(expected, kv.end());
+                ASSERT_EQ(it->current().key, expected->first);
+                ASSERT_EQ(it->current().value, expected->second);
+            }
+            ASSERT_EQ(expected, kv.end());
+
+            expected = kv.lower_bound("key-00012345");
+            for (it->seek("key-00012345"); !it->is_eof(); it->next(), ++expected) {
+                ASSERT_NE(expected, kv.end());
+                ASSERT_EQ(it->current().key, expected->first);
+            }
+            ASSERT_EQ(expected, kv.end());
+        }
+    }
+}
+
+TEST(sstable, DirectIO)
+{
+    ScopedTmpDir dir { __func__ };
+
+    options opts;
+    opts.use_direct_io = true;
+
+    const auto kv = make_kv(20000);
+    const auto p = dir.path / "1";
+    {
+        sstable_builder builder(opts, p);
+        for (const auto& [k, v]: kv) {
+            builder.add(internal_key{ k, key_type::value }.underlying_key(), v);
+        }
+        builder.done();
+    }
+
+    const auto sst = std::make_shared<sstable>(p);
+    ASSERT_EQ(sst->count(), kv.size());
+
+    auto io = make_async_io(8);
+    block_cache blocks(1024 * 1024);
+    table_cache cache(16, { &blocks, true, access_hint::random, io.get(), true });
+
+    std::string scratch;
+    for (const auto& [k, v]: kv) {
+        const auto r = sst->get(cache, k, {}, &scratch);
+        ASSERT_TRUE(r) << k;
+        ASSERT_EQ(r->value, v);
+    }
+
+    std::vector<sstable_get> lookups;
+    for (const auto* k: { "key-123", "key-9999", "key-x" }) {
+        lookups.push_back({ sst.get(), k });
+    }
+    sstable::multi_get(cache, lookups, {});
+    ASSERT_EQ(lookups[0].result->value, kv.at("key-123"));
+    ASSERT_EQ(lookups[1].result->value, kv.at("key-9999"));
+    ASSERT_FALSE(lookups[2].result);
+
+    read_options ropts;
+    ropts.readahead_size = 256 * 1024;
+    auto it = sst->iter(cache, ropts);
+    auto expected = kv.begin();
+    for (it->seek_first(); !it->is_eof(); it->next(), ++expected) {
+        ASSERT_EQ(extract_user_key(it->current().key), expected->first);
+        ASSERT_EQ(it->current().value, expected->second);
+    }
+    ASSERT_EQ(expected, kv.end());
+}
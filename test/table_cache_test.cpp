@@ -0,0 +1,131 @@
+#include <vector>
+#include <gtest/gtest.h>
+#include "sstable/table_cache.h"
+#include "test_util.h"
+
+using namespace std;
+using namespace cloudkv;
+
+TEST(table_cache, ReuseReader)
+{
+    ScopedTmpDir dir { __func__ };
+
+    auto kv = make_kv(1024);
+    auto sst = make_sst(dir.path / "1", kv);
+
+    table_cache cache(16);
+    auto r1 = cache.get(*sst);
+    auto r2 = cache.get(*sst);
+    ASSERT_EQ(r1, r2);
+    ASSERT_EQ(cache.open_count(), 1);
+
+    auto it = sst->iter(cache);
+    auto kv_iter = kv.begin();
+    for (it->seek_first(); !it->is_eof(); it->next(), ++kv_iter) {
+        ASSERT_TRUE(kv_iter != kv.end());
+
+        const auto [k, v] = it->current();
+        ASSERT_EQ(k, kv_iter->first);
+        ASSERT_EQ(v, kv_iter->second);
+    }
+    ASSERT_TRUE(kv_iter == kv.end());
+
+    cache.evict(*sst);
+    ASSERT_EQ(cache.open_count(), 0);
+    ASSERT_NE(cache.get(*sst), r1);
+}
+
+TEST(table_cache, Bounded)
+{
+    ScopedTmpDir dir { __func__ };
+
+    const int max_open = 16;
+    table_cache cache(max_open);
+
+    std::vector<sstable_ptr> sstables;
+    for (int i = 0; i < max_open * 4; ++i) {
+        sstables.push_back(make_sst(dir.path / std::to_string(i), make_kv(8)));
+    }
+
+    for (const auto& sst: sstables) {
+        cache.get(*sst);
+        ASSERT_LE(cache.open_count(), max_open);
+    }
+
+    // evicted readers keep usable
+    auto it = sstables.front()->iter(cache);
+    for (const auto& sst: sstables) {
+        cache.get(*sst);
+    }
+
+    it->seek("key-1");
+    ASSERT_FALSE(it->is_eof());
+    ASSERT_EQ(it->current().key, "key-1");
+}
+
+TEST(table_cache, MmapReader)
+{
+    ScopedTmpDir dir { __func__ };
+
+    auto kv = make_kv(4096);
+    auto sst = make_sst(dir.path / "1", kv);
+
+    table_cache cache(16, { nullptr, true, access_hint::random });
+
+    auto it = sst->iter(cache);
+    auto kv_iter = kv.begin();
+    for (it->seek_first(); !it->is_eof(); it->next(), ++kv_iter) {
+        ASSERT_TRUE(kv_iter != kv.end());
+
+        const auto [k, v] = it->current();
+        ASSERT_EQ(k, kv_iter->first);
+        ASSERT_EQ(v, kv_iter->second);
+    }
+    ASSERT_TRUE(kv_iter == kv.end());
+
+    // mapped memory keeps valid after eviction
+    it->seek("key-100");
+    cache.evict(*sst);
+    ASSERT_FALSE(it->is_eof());
+    ASSERT_EQ(it->current().key, "key-100");
+    ASSERT_EQ(it->current().value, "value-100");
+}
+
+TEST(table_cache, Pin)
+{
+    ScopedTmpDir dir { __func__ };
+
+    std::vector<sstable_ptr> sstables;
+    for (int i = 0; i < 4; ++i) {
+        sstables.push_back(make_sst(dir.path / std::to_string(i), make_kv(1024)));
+    }
+
+    // budget for 2 sstables
+    const auto charge = sstables[0]->make_reader()->index_size_in_bytes() + sstables[0]->filter_size_in_bytes();
+    ASSERT_GT(charge, 0);
+
+    table_cache cache(1, {}, charge * 2 + charge / 2);
+    ASSERT_TRUE(cache.pin(*sstables[0]));
+    ASSERT_TRUE(cache.pin(*sstables[0]));
+    ASSERT_EQ(cache.pinned_bytes(), charge);
+
+    const auto r = cache.get(*sstables[0]);
+    ASSERT_TRUE(cache.pin(*sstables[1]));
+    ASSERT_FALSE(cache.pin(*sstables[2]));
+    ASSERT_EQ(cache.pinned_bytes(), charge * 2);
+
+    // pinned readers survive lru eviction by others
+    cache.get(*sstables[2]);
+    cache.get(*sstables[3]);
+    ASSERT_EQ(cache.get(*sstables[0]), r);
+
+    cache.evict(*sstables[0]);
+    ASSERT_EQ(cache.pinned_bytes(), charge);
+    ASSERT_NE(cache.get(*sstables[0]), r);
+    ASSERT_TRUE(cache.pin(*sstables[2]));
+
+    // disabled without budget
+    table_cache unpinned(16);
+    ASSERT_FALSE(unpinned.pin(*sstables[0]));
+    ASSERT_EQ(unpinned.pinned_bytes(), 0);
+}
@@ -27,10 +27,17 @@ public:
         db_.reset(db);
     }
 
-    std::optional<std::string> query(std::string_view key) override
+    using kv_store::query;
+    using kv_store::multi_query;
+    using kv_store::iter;
+
+    std::optional<std::string> query(const read_options& opts, std::string_view key) override
     {
+        leveldb::ReadOptions ldb_options;
+        ldb_options.verify_checksums = opts.verify_checksums;
+
         std::string r;
-        auto s = db_->Get({}, as_slice(key), &r);
+        auto s = db_->Get(ldb_options, as_slice(key), &r);
         if (s.ok()) {
             return r;
         } else if (s.IsNotFound()) {
@@ -40,6 +47,29 @@ public:
         }
     }
 
+    // leveldb has no pinned values
+    bool query(const read_options& opts, std::string_view key, pinnable_value* value) override
+    {
+        auto r = query(opts, key);
+        if (!r) {
+            return false;
+        }
+
+        value->assign(std::move(*r));
+        return true;
+    }
+
+    std::vector<std::optional<std::string>> multi_query(const read_options& opts, const std::vector<std::string_view>& keys) override
+    {
+        std::vector<std::optional<std::string>> values;
+        values.reserve(keys.size());
+        for (const auto key: keys) {
+            values.push_back(query(opts, key));
+        }
+
+        return values;
+    }
+
     void batch_add(const write_batch& key_values) override
     {
         using namespace leveldb;
@@ -83,7 +113,21 @@ public:
         }
     }
 
-    iter_ptr iter() override
+    std::optional<std::uint64_t> property(std::string_view name) override
+    {
+        std::string value;
+        if (!db_->GetProperty(as_slice(name), &value)) {
+            return {};
+        }
+
+        try {
+            return std::stoull(value);
+        } catch (std::exception&) {
+            return {};
+        }
+    }
+
+    iter_ptr iter(const read_options&) override
     {
         // todo
         return {};
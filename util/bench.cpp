@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <random>
 #include <atomic>
 #include <thread>
@@ -31,6 +32,9 @@ DEFINE_uint32(val_size, 128, "value size");
 DEFINE_string(db_name, "db_bench", "db name for bench");
 DEFINE_string(db_type, "cloudkv", "cloudkv or leveldb");
 DEFINE_bool(use_existing_db, false, "use existing db or create new");
+DEFINE_bool(verify_checksums, true, "verify block checksums on reads");
+DEFINE_uint32(multiget_batch, 16, "keys per multi_query of multireadrandom");
+DEFINE_bool(pinned_reads, false, "readrandom queries pinned values instead of copies");
 
 struct Test_conf {
     boost::barrier started;
@@ -74,24 +78,80 @@ void fill_random(Thread_ctx& ctx)
     }
 }
 
+read_options make_read_options()
+{
+    read_options opts;
+    opts.verify_checksums = FLAGS_verify_checksums;
+
+    return opts;
+}
+
 void read_random(Thread_ctx& ctx)
 {
+    const auto opts = make_read_options();
+
     std::random_device random_device;
     std::mt19937 engine{random_device()};
     std::uniform_int_distribution<int> dist(0, FLAGS_key_count - 1);
 
     const kv_ptr& kv = ctx.conf.db;
+    pinnable_value value;
     for (const auto i: indices(FLAGS_key_count)) {
         (void)i;
 
         auto key = fmt::format("{:016}", dist(engine));
-        kv->query(key);
+        if (FLAGS_pinned_reads) {
+            kv->query(opts, key, &value);
+        } else {
+            kv->query(opts, key);
+        }
+        ctx.cnt.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void multi_read_random(Thread_ctx& ctx)
+{
+    const auto opts = make_read_options();
+
+    std::random_device random_device;
+    std::mt19937 engine{random_device()};
+    std::uniform_int_distribution<int> dist(0, FLAGS_key_count - 1);
+
+    const kv_ptr& kv = ctx.conf.db;
+    const auto batch = std::max<std::uint32_t>(FLAGS_multiget_batch, 1);
+
+    std::vector<std::string> keys(batch);
+    std::vector<std::string_view> key_refs(keys.begin(), keys.end());
+    for (const auto i: indices(FLAGS_key_count / batch)) {
+        (void)i;
+
+        for (const auto k: indices(batch)) {
+            keys[k] = fmt::format("{:016}", dist(engine));
+            key_refs[k] = keys[k];
+        }
+
+        kv->multi_query(opts, key_refs);
+        ctx.cnt.fetch_add(batch, std::memory_order_relaxed);
+    }
+}
+
+// full scan from the last key backward
+void read_reverse(Thread_ctx& ctx)
+{
+    const auto it = ctx.conf.db->iter(make_read_options());
+    if (!it) {
+        return;
+    }
+
+    for (it->seek_last(); !it->is_eof(); it->prev()) {
         ctx.cnt.fetch_add(1, std::memory_order_relaxed);
     }
 }
 
 void read_random_forever(Thread_ctx& ctx)
 {
+    const auto opts = make_read_options();
+
     std::random_device random_device;
     std::mt19937 engine{random_device()};
     std::uniform_int_distribution<int> dist(0, FLAGS_key_count - 1);
@@ -103,7 +163,7 @@ void read_random_forever(Thread_ctx& ctx)
             (void)i;
 
             auto key = fmt::format("{:016}", dist(engine));
-            kv->query(key);
+            kv->query(opts, key);
             ctx.cnt.fetch_add(1, std::memory_order_relaxed);
         }
     }
@@ -130,6 +190,10 @@ Bench_case get_benchmark()
         return { fill_random, false };
     } else if (FLAGS_benchmark == "readrandom") {
         return { read_random, true };
+    } else if (FLAGS_benchmark == "multireadrandom") {
+        return { multi_read_random, true };
+    } else if (FLAGS_benchmark == "readreverse") {
+        return { read_reverse, true };
     } else if (FLAGS_benchmark == "readforever") {
         return { read_random_forever, true };
     } else {
@@ -0,0 +1,102 @@
+#include <chrono>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include <fmt/core.h>
+#include <gflags/gflags.h>
+#include <range/v3/view.hpp>
+#include "cloudkv/options.h"
+#include "sstable/block.h"
+#include "sstable/block_builder.h"
+
+using namespace cloudkv;
+
+using ranges::views::indices;
+
+DEFINE_uint32(key_size, 16, "key size");
+DEFINE_uint32(val_size, 16, "value size");
+DEFINE_uint32(block_size, 32 * 1024, "bytes per block");
+DEFINE_uint32(restart_interval, 16, "keys between restart points, 1 as index blocks");
+DEFINE_uint32(seeks, 4 * 1024 * 1024, "seeks per run");
+
+using clock_type = std::chrono::steady_clock;
+
+double seconds_since(clock_type::time_point start)
+{
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+// decimal keys as the bench writes, sharing a long prefix inside a block
+std::vector<std::string> make_keys()
+{
+    std::mt19937_64 engine(0);
+    std::map<std::string, std::string> kv;
+
+    const auto entry_size = FLAGS_key_size + FLAGS_val_size;
+    while (kv.size() * entry_size < FLAGS_block_size) {
+        const auto k = fmt::format("{:0{}}", engine() % 100000000, FLAGS_key_size);
+        kv.emplace(k.substr(k.size() - FLAGS_key_size), std::string(FLAGS_val_size, ' '));
+    }
+
+    std::vector<std::string> keys;
+    for (const auto& [k, v]: kv) {
+        keys.push_back(k);
+    }
+
+    return keys;
+}
+
+std::string build(const std::vector<std::string>& keys, sst::block_format format, bool key_heads)
+{
+    block_builder builder({}, FLAGS_restart_interval, format, key_heads);
+    for (const auto& k: keys) {
+        builder.add(k, std::string(FLAGS_val_size, ' '));
+    }
+
+    return std::string(builder.done());
+}
+
+void bench(const char* name, const std::vector<std::string>& keys, sst::block_format format, bool key_heads)
+{
+    const block blk(build(keys, format, key_heads));
+
+    std::mt19937 engine(1);
+    std::uniform_int_distribution<std::size_t> dist(0, keys.size() - 1);
+    std::vector<std::size_t> targets;
+    for (const auto i: indices(FLAGS_seeks)) {
+        (void)i;
+        targets.push_back(dist(engine));
+    }
+
+    auto it = blk.iter();
+    std::uint64_t found = 0;
+    auto start = clock_type::now();
+    for (const auto t: targets) {
+        it->seek(keys[t]);
+        found += !it->is_eof();
+    }
+    const auto iter_ns = seconds_since(start) * 1e9 / FLAGS_seeks;
+
+    std::string scratch;
+    start = clock_type::now();
+    for (const auto t: targets) {
+        found += blk.lower_bound(keys[t], &scratch).has_value();
+    }
+    const auto lower_bound_ns = seconds_since(start) * 1e9 / FLAGS_seeks;
+
+    fmt::print("{:<14} {:>8} bytes  block_iter::seek {:>7.1f} ns  lower_bound {:>7.1f} ns  ({} found)\n",
+        name, blk.size_in_bytes(), iter_ns, lower_bound_ns, found);
+}
+
+int main(int argc, char** argv)
+{
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+    const auto keys = make_keys();
+    fmt::print("{} keys of {} bytes, restart interval {}\n", keys.size(), FLAGS_key_size, FLAGS_restart_interval);
+
+    bench("flat", keys, sst::block_format::flat, false);
+    bench("prefix", keys, sst::block_format::prefix, false);
+    bench("prefix+heads", keys, sst::block_format::prefix, true);
+}
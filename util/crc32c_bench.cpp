@@ -0,0 +1,110 @@
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <fmt/core.h>
+#include <gflags/gflags.h>
+#include <range/v3/view.hpp>
+#include "cloudkv/db.h"
+#include "util/crc32c.h"
+
+using namespace cloudkv;
+
+using ranges::views::indices;
+
+DEFINE_uint32(block_size, 32 * 1024, "bytes per crc computation");
+DEFINE_uint32(crc_rounds, 100000, "crc computations per run");
+DEFINE_uint32(key_count, 1024 * 1024, "keys filled");
+DEFINE_uint32(val_size, 128, "value size");
+DEFINE_uint32(lookups, 1024 * 1024, "random lookups per run");
+DEFINE_string(db_name, "crc32c_bench", "db name for bench");
+
+constexpr std::uint32_t batch_size = 8;
+
+using clock_type = std::chrono::steady_clock;
+
+double seconds_since(clock_type::time_point start)
+{
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+template <class Fn>
+void bench_crc(const char* name, Fn fn)
+{
+    std::string buf(FLAGS_block_size, 'x');
+
+    std::uint32_t crc = 0;
+    const auto start = clock_type::now();
+    for (const auto i: indices(FLAGS_crc_rounds)) {
+        (void)i;
+        crc = fn(crc, buf.data(), buf.size());
+    }
+
+    const auto secs = seconds_since(start);
+    const double bytes = double(FLAGS_block_size) * FLAGS_crc_rounds;
+    fmt::print("{:<10} {:>8.2f} GB/s (crc={:08x})\n", name, bytes / secs / 1e9, crc);
+}
+
+void fill_db(kv_store& db)
+{
+    fmt::print("fill {} keys\n", FLAGS_key_count);
+
+    const std::string value(FLAGS_val_size, ' ');
+    for (const auto i: indices(FLAGS_key_count / batch_size)) {
+        write_batch batch;
+        for (const auto k: indices(batch_size)) {
+            batch.add(fmt::format("{:016}", i * batch_size + k), value);
+        }
+
+        db.batch_add(batch);
+    }
+}
+
+// same as readrandom of bench
+double read_random(kv_store& db, bool verify_checksums)
+{
+    std::mt19937 engine(0);
+    std::uniform_int_distribution<std::uint32_t> dist(0, FLAGS_key_count - 1);
+
+    read_options opts;
+    opts.verify_checksums = verify_checksums;
+
+    std::uint64_t found = 0;
+    const auto start = clock_type::now();
+    for (const auto i: indices(FLAGS_lookups)) {
+        (void)i;
+
+        found += db.query(opts, fmt::format("{:016}", dist(engine))).has_value();
+    }
+
+    const auto secs = seconds_since(start);
+    const auto qps = FLAGS_lookups / secs;
+    fmt::print("readrandom verify={:<5} {:>10.0f} qps, {} found\n", verify_checksums, qps, found);
+
+    return qps;
+}
+
+int main(int argc, char** argv)
+{
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+    fmt::print("hardware accelerated: {}\n", crc32c::is_hardware_accelerated());
+    bench_crc("extend", crc32c::extend);
+    bench_crc("portable", crc32c::extend_portable);
+
+    std::filesystem::remove_all(FLAGS_db_name);
+    fill_db(*open(FLAGS_db_name, {}));
+
+    // reopen to read from sstables only
+    auto db = open(FLAGS_db_name, {});
+
+    // warm up page cache
+    read_random(*db, false);
+
+    const auto without = read_random(*db, false);
+    const auto with = read_random(*db, true);
+    fmt::print("checksum overhead: {:.2f}%\n", (without - with) / without * 100);
+
+    db.reset();
+    std::filesystem::remove_all(FLAGS_db_name);
+}
@@ -0,0 +1,89 @@
+#include <chrono>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fmt/core.h>
+#include <gflags/gflags.h>
+#include <range/v3/view.hpp>
+#include "iterator/merge_iterator.h"
+#include "memtable/memtable.h"
+
+using namespace cloudkv;
+
+using ranges::views::indices;
+
+DEFINE_string(children, "16,64", "child iterator counts to bench, comma separated");
+DEFINE_uint32(key_count, 1024 * 1024, "keys in all children");
+DEFINE_uint32(key_size, 16, "key size");
+DEFINE_uint32(val_size, 16, "value size");
+DEFINE_double(overlap, 0.1, "fraction of keys also in another child");
+DEFINE_uint32(runs, 3, "full scans per child count");
+
+using clock_type = std::chrono::steady_clock;
+
+double seconds_since(clock_type::time_point start)
+{
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+// keys spread over children at random, as overlapping sstables are
+std::vector<std::unique_ptr<memtable>> make_children(std::uint32_t n)
+{
+    std::mt19937_64 engine(n);
+    std::vector<std::unique_ptr<memtable>> children;
+    for (const auto i: indices(n)) {
+        (void)i;
+        children.push_back(std::make_unique<memtable>());
+    }
+
+    std::uniform_real_distribution<double> coin(0, 1);
+    const std::string value(FLAGS_val_size, ' ');
+    for (const auto k: indices(FLAGS_key_count)) {
+        const auto key = fmt::format("{:0{}}", k, FLAGS_key_size);
+        children[engine() % n]->add(key_type::value, key, value);
+        if (coin(engine) < FLAGS_overlap) {
+            children[engine() % n]->add(key_type::value, key, value);
+        }
+    }
+
+    return children;
+}
+
+void bench(std::uint32_t n)
+{
+    const auto children = make_children(n);
+
+    double best = 0;
+    std::uint64_t scanned = 0;
+    for (const auto run: indices(FLAGS_runs)) {
+        std::vector<iter_ptr> iterators;
+        for (const auto& mt: children) {
+            iterators.push_back(mt->iter());
+        }
+        merge_iterator it(std::move(iterators));
+
+        scanned = 0;
+        const auto start = clock_type::now();
+        for (it.seek_first(); !it.is_eof(); it.next()) {
+            scanned += it.current().value.size() > 0;
+        }
+        const auto elapsed = seconds_since(start);
+        best = run == 0? elapsed: std::min(best, elapsed);
+    }
+
+    fmt::print("{:>4} children  {} keys  {:>7.1f} ns/key  {:>7.2f} Mkeys/s\n",
+        n, scanned, best * 1e9 / scanned, scanned / best / 1e6);
+}
+
+int main(int argc, char** argv)
+{
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+    std::stringstream ss(FLAGS_children);
+    std::string n;
+    while (std::getline(ss, n, ',')) {
+        bench(std::stoul(n));
+    }
+}
@@ -1,3 +1,5 @@
+add_includedirs("../src/")
+
 function all_utils()
     local res = {}
     for _, x in ipairs(os.files("*.cpp")) do
@@ -22,6 +22,8 @@ add_requires("spdlog v1.9.1", { configs = { fmt_external = true } })
 add_requires("range-v3 0.11.0")
 add_requires("scope_guard 0.9.1")
 add_requires("folly 2021.08.02")
+add_requires("lz4 v1.9.3")
+add_requires("zstd v1.5.0")
 add_requireconfs("folly.boost", { version = "1.76.0", override = true, configs = boost_configs })
 
 target("cloudkv")
@@ -39,6 +41,8 @@ target("cloudkv")
     add_packages("range-v3")
     add_packages("scope_guard")
     add_packages("folly")
+    add_packages("lz4", { public = true })
+    add_packages("zstd", { public = true })
 
 option("with_test")
     set_default(false)